@@ -23,6 +23,15 @@ LOCAL_C_INCLUDES += $(LOCAL_PATH)/include
 
 LOCAL_LDLIBS     += -llog -ldl
 
+# armeabi-v7a: the matching kernels use NEON intrinsics
+LOCAL_ARM_NEON   := true
+
+# ndk-build EMBED_MODEL=1 compiles the model into the library; generate
+# jni/embedded_model.h with tools/embed_model.cpp first
+ifeq ($(EMBED_MODEL),1)
+LOCAL_CFLAGS     += -DEMBEDDED_MODEL
+endif
+
 LOCAL_MODULE     := detection_based_tracker
 
 include $(BUILD_SHARED_LIBRARY)
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include <stdlib.h>
+#include <unistd.h>
 
 #include <android/log.h>
 //#include "lbp.h"
@@ -13,6 +14,9 @@
 
 #include "include/lbp-adapter.hpp"
 #include "learnonandroid.h"
+#include "detectorsession.h"
+#include "mappedfile.h"
+#include "scanparameters.h"
 
 
 #define LOG_TAG "FaceDetection/DetectionBasedTracker"
@@ -23,7 +27,42 @@ using namespace cv;
 
 inline void vector_Rect_to_Mat(vector<Rect>& v_rect, Mat& mat)
 {
-    mat = Mat(v_rect, true);
+    // keeps mat's buffer while the number of faces does not change
+    Mat(v_rect).copyTo(mat);
+}
+
+// a copy of a Java byte array, empty for null
+static string byte_array(JNIEnv* jenv, jbyteArray array)
+{
+    if (array == NULL)
+        return string();
+
+    string bytes((size_t)jenv->GetArrayLength(array), '\0');
+    if (!bytes.empty())
+        jenv->GetByteArrayRegion(array, 0, (jsize)bytes.size(), (jbyte*)&bytes[0]);
+    return bytes;
+}
+
+// what nativeMyDetector answers with while it cannot run the LBP-SVM scan
+static void detect_with_cascade(DetectorSession* session, const Mat& mGr, Mat& mRgb)
+{
+    vector<Rect> RectFaces;
+    session->detect(mGr, RectFaces);
+
+    vector<Detection>& detections = session->begin_frame();
+    for (size_t i = 0; i < RectFaces.size(); i++)
+    {
+        if (!mRgb.empty())
+            rectangle(mRgb, RectFaces[i].tl(), RectFaces[i].br(), Scalar(0, 255, 0, 255), 3);
+
+        Detection detection;
+        detection.box = RectFaces[i];
+        detection.score = 0.0f;
+        detection.level = -1;
+        detection.track = -1;
+        detections.push_back(detection);
+    }
+    session->publish_detections();
 }
 
 JNIEXPORT jlong JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeCreateObject
@@ -36,10 +75,9 @@ JNIEXPORT jlong JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker
 
     try
     {
-        DetectionBasedTracker::Parameters DetectorParams;
-        if (faceSize > 0)
-            DetectorParams.minObjectSize = faceSize;
-        result = (jlong)new DetectionBasedTracker(stdFileName, DetectorParams);
+        // the LBP-SVM models are read on a background thread, see
+        // detectorsession.h; the cascade is usable right away
+        result = (jlong)new DetectorSession(stdFileName, faceSize, "/storage/sdcard0/");
     }
     catch(cv::Exception& e)
     {
@@ -61,6 +99,82 @@ JNIEXPORT jlong JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker
     return result;
 }
 
+JNIEXPORT jlong JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeCreateObjectFromFd
+(JNIEnv * jenv, jclass, jint cascadeFd, jlong cascadeOffset, jlong cascadeLength,
+ jint bundleFd, jlong bundleOffset, jlong bundleLength, jint faceSize)
+{
+    LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeCreateObjectFromFd enter");
+    jlong result = 0;
+
+    try
+    {
+        // both are read in place, e.g. uncompressed entries of the APK
+        MappedFile cascade;
+        cascade.map(cascadeFd, (off_t)cascadeOffset, (size_t)cascadeLength);
+        result = (jlong)new DetectorSession(cascade.data(), cascade.size(), faceSize, "/storage/sdcard0/",
+                                            bundleFd, (off_t)bundleOffset, (size_t)bundleLength);
+    }
+    catch(cv::Exception& e)
+    {
+        LOGD("nativeCreateObjectFromFd caught cv::Exception: %s", e.what());
+        jclass je = jenv->FindClass("org/opencv/core/CvException");
+        if(!je)
+            je = jenv->FindClass("java/lang/Exception");
+        jenv->ThrowNew(je, e.what());
+    }
+    catch (...)
+    {
+        LOGD("nativeCreateObjectFromFd caught unknown exception");
+        jclass je = jenv->FindClass("java/lang/Exception");
+        jenv->ThrowNew(je, "Unknown exception in JNI code of DetectionBasedTracker.nativeCreateObjectFromFd()");
+        return 0;
+    }
+
+    LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeCreateObjectFromFd exit");
+    return result;
+}
+
+JNIEXPORT jlong JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeCreateObjectFromBuffer
+(JNIEnv * jenv, jclass, jbyteArray cascadeBuffer, jbyteArray bundleBuffer, jbyteArray modelBuffer,
+ jbyteArray meanBuffer, jbyteArray stdBuffer, jbyteArray prefilterBuffer, jbyteArray intersectionBuffer,
+ jint faceSize)
+{
+    LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeCreateObjectFromBuffer enter");
+    jlong result = 0;
+
+    try
+    {
+        // copied, the loading thread parses the models after this returns
+        ModelData models;
+        models.bundle = byte_array(jenv, bundleBuffer);
+        models.model = byte_array(jenv, modelBuffer);
+        models.mean = byte_array(jenv, meanBuffer);
+        models.deviation = byte_array(jenv, stdBuffer);
+        models.prefilter = byte_array(jenv, prefilterBuffer);
+        models.intersection = byte_array(jenv, intersectionBuffer);
+
+        string cascade = byte_array(jenv, cascadeBuffer);
+        result = (jlong)new DetectorSession(cascade.data(), cascade.size(), faceSize, "/storage/sdcard0/", models);
+    }
+    catch(cv::Exception& e)
+    {
+        LOGD("nativeCreateObjectFromBuffer caught cv::Exception: %s", e.what());
+        jclass je = jenv->FindClass("org/opencv/core/CvException");
+        if(!je)
+            je = jenv->FindClass("java/lang/Exception");
+        jenv->ThrowNew(je, e.what());
+    }
+    catch (...)
+    {
+        LOGD("nativeCreateObjectFromBuffer caught unknown exception");
+        jclass je = jenv->FindClass("java/lang/Exception");
+        jenv->ThrowNew(je, "Unknown exception in JNI code of DetectionBasedTracker.nativeCreateObjectFromBuffer()");
+    }
+
+    LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeCreateObjectFromBuffer exit");
+    return result;
+}
+
 JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeDestroyObject
 (JNIEnv * jenv, jclass, jlong thiz)
 {
@@ -69,8 +183,8 @@ JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_
     {
         if(thiz != 0)
         {
-            ((DetectionBasedTracker*)thiz)->stop();
-            delete (DetectionBasedTracker*)thiz;
+            ((DetectorSession*)thiz)->stop();
+            delete (DetectorSession*)thiz;
         }
     }
     catch(cv::Exception& e)
@@ -96,7 +210,7 @@ JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_
     LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeStart enter");
     try
     {
-        ((DetectionBasedTracker*)thiz)->run();
+        ((DetectorSession*)thiz)->start();
     }
     catch(cv::Exception& e)
     {
@@ -121,7 +235,7 @@ JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_
     LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeStop enter");
     try
     {
-        ((DetectionBasedTracker*)thiz)->stop();
+        ((DetectorSession*)thiz)->stop();
     }
     catch(cv::Exception& e)
     {
@@ -146,13 +260,7 @@ JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_
     LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeSetFaceSize enter");
     try
     {
-        if (faceSize > 0)
-        {
-            DetectionBasedTracker::Parameters DetectorParams = \
-            ((DetectionBasedTracker*)thiz)->getParameters();
-            DetectorParams.minObjectSize = faceSize;
-            ((DetectionBasedTracker*)thiz)->setParameters(DetectorParams);
-        }
+        ((DetectorSession*)thiz)->set_face_size(faceSize);
     }
     catch(cv::Exception& e)
     {
@@ -179,8 +287,7 @@ JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_
     try
     {
         vector<Rect> RectFaces;
-        ((DetectionBasedTracker*)thiz)->process(*((Mat*)imageGray));
-        ((DetectionBasedTracker*)thiz)->getObjects(RectFaces);
+        ((DetectorSession*)thiz)->detect(*((Mat*)imageGray), RectFaces);
         vector_Rect_to_Mat(RectFaces, *((Mat*)faces));
     }
     catch(cv::Exception& e)
@@ -200,36 +307,269 @@ JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_
     LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeDetect exit");
 }
 
-JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeMyDetector
-(JNIEnv * jenv, jclass, jlong thiz, jlong imageGray, jlong addrRgba, jlong faces)
+// The LBP-SVM scan of one frame. luma is the camera's gray image, and may
+// be a view on the preview buffer: it is only read, blurred into a buffer
+// the session keeps and scaled to the first pyramid level. The faces'
+// boxes, in camera pixels, are drawn on mRgb unless it is empty; the rest
+// of the frame is left as it is.
+static void detect_faces(DetectorSession* session, const Mat& luma, Mat& mRgb)
 {
-    LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeMyDetector enter!!!");
-    Mat& mGr  = *(Mat*)imageGray;
-    Mat& mRgb = *(Mat*)addrRgba;
+	// the frame runs on the models published when it starts, a swap during
+	// the scan frees them only after the reference is gone
+	ModelReference models(session);
+
+	// until the background load is done, answer with the cascade
+	if (models.get() == NULL) {
+		detect_with_cascade(session, luma, mRgb);
+		LOGD("detect_faces: model not ready, using the cascade");
+		return;
+	}
 
-	string  classification_model = "/storage/sdcard0/svm_model.xml";
+	ScanParameters parameters = session->get_scan_parameters();
 
-	Mat original;
+	// a swapped bundle may not fit parameters set for the previous one
+	int dimension = models.get()->descriptor_dimension();
+	if (dimension > 0 && dimension != parameters.descriptor_dimension()) {
+		LOGD("scan parameters give %d features, the model takes %d; using the cascade",
+			 parameters.descriptor_dimension(), dimension);
+		detect_with_cascade(session, luma, mRgb);
+		return;
+	}
 
-	mGr.copyTo(original);
-//	equalizeHist(original, mGr);
+	// the faces go to the result buffer, see detection.h
+	vector<Detection>& detections = session->begin_frame();
 
-	GaussianBlur(original, mGr, Size(3,3), 1.5);
+	// only the levels that can hold a face of the requested size are built
+	vector<int> levels;
+	parameters.scanned_levels(luma.size(), levels);
+	if (levels.empty()) {
+		session->publish_detections();
+		LOGD("detect_faces: no level in the face size range");
+		return;
+	}
 
-	original.release();
+	Mat piramide;
+	parameters.build_level(luma, levels[0], session->get_blurred_frame(), piramide);
 
-	Mat piramide = Mat(Size(mGr.cols/2, mGr.rows/2), mGr.type());
-	Mat piramide_rgb = Mat(Size(mRgb.cols/2, mRgb.rows/2), mGr.type());
+	LearnOnAndroid& learn_on_android = session->get_scanner();
+	learn_on_android.set_scan_parameters(parameters);
+	learn_on_android.use_models(*models.get());
 
-	resize(mGr, piramide, piramide.size());
-	resize(mRgb, piramide_rgb, piramide_rgb.size());
+	// the counts restart with the audit, so the recall loss covers it only
+	bool audit = session->get_prefilter_audit();
+	if (audit != learn_on_android.get_prefilter_audit()) {
+		learn_on_android.set_prefilter_audit(audit);
+		learn_on_android.reset_prefilter_statistics();
+	}
+#ifdef EMBEDDED_MODEL
+	learn_on_android.set_embedded_model(true);
+#endif
 
-	LearnOnAndroid learn_on_android(piramide, classification_model);
-	learn_on_android.scaning_image(piramide_rgb);
+	// the scanner only collects the faces, they are drawn below
+	Mat level, none;
+	for (size_t l = 0; l < levels.size(); l++) {
+
+		double scale = parameters.level_scale(levels[l]);
+
+		if (l == 0)
+			level = piramide;
+		else
+			resize(piramide, level, Size(cvRound(luma.cols*scale), cvRound(luma.rows*scale)));
+
+		learn_on_android.set_image(level);
+		learn_on_android.scaning_image(none);
+
+		// back to camera pixels
+		const vector<Detection>& found = learn_on_android.get_detections();
+		for (size_t i = 0; i < found.size(); i++) {
+			Detection detection = found[i];
+			detection.box = Rect(cvRound(detection.box.x/scale), cvRound(detection.box.y/scale),
+								 cvRound(detection.box.width/scale), cvRound(detection.box.height/scale));
+			detection.level = levels[l];
+			detections.push_back(detection);
+		}
+	}
 
 //	learn_on_android.input_image.copyTo(mRgb);
 
-	resize(piramide_rgb, mRgb, mRgb.size());
+	if (!mRgb.empty()) {
+		for (size_t i = 0; i < detections.size(); i++)
+			rectangle(mRgb, detections[i].box.tl(), detections[i].box.br(), Scalar(255, 0, 0, 255), 2);
+	}
+
+	session->publish_detections();
+}
+
+JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeMyDetector
+(JNIEnv * jenv, jclass, jlong thiz, jlong imageGray, jlong addrRgba)
+{
+    LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeMyDetector enter!!!");
+    try
+    {
+        Mat& mGr  = *(Mat*)imageGray;
+        Mat& mRgb = *(Mat*)addrRgba;
+
+        detect_faces((DetectorSession*)thiz, mGr, mRgb);
+    }
+    catch(cv::Exception& e)
+    {
+        LOGD("nativeMyDetector caught cv::Exception: %s", e.what());
+        jclass je = jenv->FindClass("org/opencv/core/CvException");
+        if(!je)
+            je = jenv->FindClass("java/lang/Exception");
+        jenv->ThrowNew(je, e.what());
+    }
+    catch (...)
+    {
+        LOGD("nativeMyDetector caught unknown exception");
+        jclass je = jenv->FindClass("java/lang/Exception");
+        jenv->ThrowNew(je, "Unknown exception in JNI code DetectionBasedTracker.nativeMyDetector()");
+    }
 
     LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeMyDetector exit");
 }
+
+JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeMyDetectorNv21
+(JNIEnv * jenv, jclass, jlong thiz, jlong yPlane, jint width, jint height, jint stride)
+{
+    LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeMyDetectorNv21 enter");
+
+    try
+    {
+        // the Y plane heads an NV21 frame: width x height bytes, rows stride
+        // bytes apart; wrapped, not copied
+        Mat luma(height, width, CV_8UC1, (void*)yPlane, (size_t)stride);
+        Mat none;
+
+        detect_faces((DetectorSession*)thiz, luma, none);
+    }
+    catch(cv::Exception& e)
+    {
+        LOGD("nativeMyDetectorNv21 caught cv::Exception: %s", e.what());
+        jclass je = jenv->FindClass("org/opencv/core/CvException");
+        if(!je)
+            je = jenv->FindClass("java/lang/Exception");
+        jenv->ThrowNew(je, e.what());
+    }
+    catch (...)
+    {
+        LOGD("nativeMyDetectorNv21 caught unknown exception");
+        jclass je = jenv->FindClass("java/lang/Exception");
+        jenv->ThrowNew(je, "Unknown exception in JNI code DetectionBasedTracker.nativeMyDetectorNv21()");
+    }
+
+    LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeMyDetectorNv21 exit");
+}
+
+JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeSetResultBuffer
+(JNIEnv * jenv, jclass, jlong thiz, jobject buffer)
+{
+    // a direct ByteBuffer the Java wrapper keeps for its whole life
+    ((DetectorSession*)thiz)->set_result_buffer(jenv->GetDirectBufferAddress(buffer),
+                                                (size_t)jenv->GetDirectBufferCapacity(buffer));
+}
+
+JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeSetPrefilterAudit
+(JNIEnv *, jclass, jlong thiz, jboolean audit)
+{
+    // picked up by the next frame
+    ((DetectorSession*)thiz)->set_prefilter_audit(audit == JNI_TRUE);
+}
+
+JNIEXPORT jdouble JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeModelLoadTime
+(JNIEnv *, jclass, jlong thiz)
+{
+    DetectorSession* session = (DetectorSession*)thiz;
+    if (session->state() != MODEL_READY)
+        return -1.0;
+    return session->get_load_milliseconds();
+}
+
+JNIEXPORT jint JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeModelState
+(JNIEnv *, jclass, jlong thiz)
+{
+    return ((DetectorSession*)thiz)->state();
+}
+
+JNIEXPORT jstring JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeModelLoadError
+(JNIEnv * jenv, jclass, jlong thiz)
+{
+    // empty unless the latest load failed
+    return jenv->NewStringUTF(((DetectorSession*)thiz)->get_load_error().c_str());
+}
+
+JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeSetScanParameters
+(JNIEnv * jenv, jclass, jlong thiz, jint stride, jint boxSize, jint cellSize, jdouble downscale, jint blurSize,
+ jdouble pyramidScale, jint pyramidLevels, jint minFaceSize, jint maxFaceSize, jdouble scoreThreshold,
+ jint descriptorMode)
+{
+    LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeSetScanParameters enter");
+    try
+    {
+        ScanParameters parameters;
+        parameters.stride = stride;
+        parameters.box_size = boxSize;
+        parameters.cell_size = cellSize;
+        parameters.downscale = downscale;
+        parameters.blur_size = blurSize;
+        parameters.pyramid_scale = pyramidScale;
+        parameters.pyramid_levels = pyramidLevels;
+        parameters.min_face_size = minFaceSize;
+        parameters.max_face_size = maxFaceSize;
+        parameters.score_threshold = scoreThreshold;
+        parameters.descriptor_mode = descriptorMode;
+
+        // validated against the current models, the next frame picks them up
+        ((DetectorSession*)thiz)->set_scan_parameters(parameters);
+    }
+    catch(cv::Exception& e)
+    {
+        LOGD("nativeSetScanParameters caught cv::Exception: %s", e.what());
+        jclass je = jenv->FindClass("java/lang/IllegalArgumentException");
+        if(!je)
+            je = jenv->FindClass("java/lang/Exception");
+        jenv->ThrowNew(je, e.what());
+    }
+    catch (...)
+    {
+        LOGD("nativeSetScanParameters caught unknown exception");
+        jclass je = jenv->FindClass("java/lang/Exception");
+        jenv->ThrowNew(je, "Unknown exception in JNI code of DetectionBasedTracker.nativeSetScanParameters()");
+    }
+    LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeSetScanParameters exit");
+}
+
+JNIEXPORT jboolean JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeSwapModel
+(JNIEnv * jenv, jclass, jlong thiz, jstring jBundle)
+{
+    LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeSwapModel enter");
+    const char* jnamestr = jenv->GetStringUTFChars(jBundle, NULL);
+    string bundle(jnamestr);
+    jenv->ReleaseStringUTFChars(jBundle, jnamestr);
+
+    jboolean result = JNI_FALSE;
+
+    try
+    {
+        // returns at once, frames keep the current models until the new
+        // ones are published
+        result = ((DetectorSession*)thiz)->swap_models(bundle) ? JNI_TRUE : JNI_FALSE;
+    }
+    catch(cv::Exception& e)
+    {
+        LOGD("nativeSwapModel caught cv::Exception: %s", e.what());
+        jclass je = jenv->FindClass("org/opencv/core/CvException");
+        if(!je)
+            je = jenv->FindClass("java/lang/Exception");
+        jenv->ThrowNew(je, e.what());
+    }
+    catch (...)
+    {
+        LOGD("nativeSwapModel caught unknown exception");
+        jclass je = jenv->FindClass("java/lang/Exception");
+        jenv->ThrowNew(je, "Unknown exception in JNI code of DetectionBasedTracker.nativeSwapModel()");
+    }
+
+    LOGD("Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeSwapModel exit");
+    return result;
+}
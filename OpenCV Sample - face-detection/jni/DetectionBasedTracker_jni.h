@@ -15,6 +15,22 @@ extern "C" {
 JNIEXPORT jlong JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeCreateObject
   (JNIEnv *, jclass, jstring, jint);
 
+/*
+ * Class:     org_opencv_samples_fd_DetectionBasedTracker
+ * Method:    nativeCreateObjectFromFd
+ * Signature: (IJJIJJI)J
+ */
+JNIEXPORT jlong JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeCreateObjectFromFd
+  (JNIEnv *, jclass, jint, jlong, jlong, jint, jlong, jlong, jint);
+
+/*
+ * Class:     org_opencv_samples_fd_DetectionBasedTracker
+ * Method:    nativeCreateObjectFromBuffer
+ * Signature: ([B[B[B[B[B[B[BI)J
+ */
+JNIEXPORT jlong JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeCreateObjectFromBuffer
+  (JNIEnv *, jclass, jbyteArray, jbyteArray, jbyteArray, jbyteArray, jbyteArray, jbyteArray, jbyteArray, jint);
+
 /*
  * Class:     org_opencv_samples_fd_DetectionBasedTracker
  * Method:    nativeDestroyObject
@@ -57,11 +73,75 @@ JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_
 
 /*
  * Class:     org_opencv_samples_fd_DetectionBasedTracker
- * Method:    nativeDetect
+ * Method:    nativeMyDetector
  * Signature: (JJJ)V
  */
 JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeMyDetector
-  (JNIEnv *, jclass, jlong, jlong, jlong, jlong);
+  (JNIEnv *, jclass, jlong, jlong, jlong);
+
+/*
+ * Class:     org_opencv_samples_fd_DetectionBasedTracker
+ * Method:    nativeMyDetectorNv21
+ * Signature: (JJIII)V
+ */
+JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeMyDetectorNv21
+  (JNIEnv *, jclass, jlong, jlong, jint, jint, jint);
+
+/*
+ * Class:     org_opencv_samples_fd_DetectionBasedTracker
+ * Method:    nativeSetResultBuffer
+ * Signature: (JLjava/nio/ByteBuffer;)V
+ */
+JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeSetResultBuffer
+  (JNIEnv *, jclass, jlong, jobject);
+
+/*
+ * Class:     org_opencv_samples_fd_DetectionBasedTracker
+ * Method:    nativeSetPrefilterAudit
+ * Signature: (JZ)V
+ */
+JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeSetPrefilterAudit
+  (JNIEnv *, jclass, jlong, jboolean);
+
+/*
+ * Class:     org_opencv_samples_fd_DetectionBasedTracker
+ * Method:    nativeModelLoadTime
+ * Signature: (J)D
+ */
+JNIEXPORT jdouble JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeModelLoadTime
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_opencv_samples_fd_DetectionBasedTracker
+ * Method:    nativeModelState
+ * Signature: (J)I
+ */
+JNIEXPORT jint JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeModelState
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_opencv_samples_fd_DetectionBasedTracker
+ * Method:    nativeModelLoadError
+ * Signature: (J)Ljava/lang/String;
+ */
+JNIEXPORT jstring JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeModelLoadError
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_opencv_samples_fd_DetectionBasedTracker
+ * Method:    nativeSetScanParameters
+ * Signature: (JIIIDIDIIIDI)V
+ */
+JNIEXPORT void JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeSetScanParameters
+  (JNIEnv *, jclass, jlong, jint, jint, jint, jdouble, jint, jdouble, jint, jint, jint, jdouble, jint);
+
+/*
+ * Class:     org_opencv_samples_fd_DetectionBasedTracker
+ * Method:    nativeSwapModel
+ * Signature: (JLjava/lang/String;)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_opencv_samples_facedetect_DetectionBasedTracker_nativeSwapModel
+  (JNIEnv *, jclass, jlong, jstring);
 
 
 #ifdef __cplusplus
@@ -0,0 +1,191 @@
+#include "chisquare.h"
+
+#include <algorithm>
+#include <cfloat>
+
+// 32-bit ARM compilers define __ARM_NEON__, AArch64 (and ACLE) ones
+// __ARM_NEON
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define CHI_SQUARE_NEON 1
+#endif
+
+#if defined(CHI_SQUARE_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Galleries with fewer rows than this are scored on the calling thread.
+#define CHI_SQUARE_PARALLEL_MIN_ROWS 256
+
+// Histograms are non-negative, so a zero sum means both bins are zero and
+// the bin contributes nothing. Clamping the sum to FLT_MIN keeps the
+// reciprocal finite and the term at 0, without a branch per bin.
+
+#if defined(CHI_SQUARE_NEON)
+
+// 1/s from the NEON estimate refined by two Newton-Raphson steps, which is
+// accurate to about the last bit of a float.
+static inline float32x4_t reciprocal(float32x4_t s) {
+	float32x4_t r = vrecpeq_f32(s);
+	r = vmulq_f32(vrecpsq_f32(s, r), r);
+	r = vmulq_f32(vrecpsq_f32(s, r), r);
+	return r;
+}
+
+static inline float32x4_t chi_square_step(float32x4_t acc, float32x4_t a, float32x4_t b) {
+	float32x4_t d = vsubq_f32(a, b);
+	float32x4_t s = vmaxq_f32(vaddq_f32(a, b), vdupq_n_f32(FLT_MIN));
+	return vmlaq_f32(acc, vmulq_f32(d, d), reciprocal(s));
+}
+
+static inline float horizontal_sum(float32x4_t acc) {
+	float32x2_t h = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+	return vget_lane_f32(vpadd_f32(h, h), 0);
+}
+
+#elif defined(__SSE2__)
+
+// 1/s from the SSE estimate refined by one Newton-Raphson step.
+static inline __m128 reciprocal(__m128 s) {
+	__m128 r = _mm_rcp_ps(s);
+	return _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(2.0f), _mm_mul_ps(s, r)));
+}
+
+static inline __m128 chi_square_step(__m128 acc, __m128 a, __m128 b) {
+	__m128 d = _mm_sub_ps(a, b);
+	__m128 s = _mm_max_ps(_mm_add_ps(a, b), _mm_set1_ps(FLT_MIN));
+	return _mm_add_ps(acc, _mm_mul_ps(_mm_mul_ps(d, d), reciprocal(s)));
+}
+
+static inline float horizontal_sum(__m128 acc) {
+	float lanes[4];
+	_mm_storeu_ps(lanes, acc);
+	return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+#endif
+
+static inline float chi_square_bin(float a, float b) {
+	float d = a - b;
+	float s = a + b;
+	return s > FLT_MIN ? d*d/s : 0.0f;
+}
+
+float lbp::chi_square_f32(const float* probe, const float* gallery, int n) {
+	int i = 0;
+	float result = 0.0f;
+#if defined(CHI_SQUARE_NEON)
+	float32x4_t acc = vdupq_n_f32(0.0f);
+	for(; i <= n - 4; i += 4) {
+		acc = chi_square_step(acc, vld1q_f32(probe + i), vld1q_f32(gallery + i));
+	}
+	result = horizontal_sum(acc);
+#elif defined(__SSE2__)
+	__m128 acc = _mm_setzero_ps();
+	for(; i <= n - 4; i += 4) {
+		acc = chi_square_step(acc, _mm_loadu_ps(probe + i), _mm_loadu_ps(gallery + i));
+	}
+	result = horizontal_sum(acc);
+#endif
+	for(; i < n; i++) {
+		result += chi_square_bin(probe[i], gallery[i]);
+	}
+	return result;
+}
+
+float lbp::chi_square_u16(const float* probe, const unsigned short* gallery, int n) {
+	int i = 0;
+	float result = 0.0f;
+#if defined(CHI_SQUARE_NEON)
+	float32x4_t acc = vdupq_n_f32(0.0f);
+	for(; i <= n - 8; i += 8) {
+		uint16x8_t g = vld1q_u16(gallery + i);
+		acc = chi_square_step(acc, vld1q_f32(probe + i), vcvtq_f32_u32(vmovl_u16(vget_low_u16(g))));
+		acc = chi_square_step(acc, vld1q_f32(probe + i + 4), vcvtq_f32_u32(vmovl_u16(vget_high_u16(g))));
+	}
+	result = horizontal_sum(acc);
+#elif defined(__SSE2__)
+	__m128 acc = _mm_setzero_ps();
+	__m128i zero = _mm_setzero_si128();
+	for(; i <= n - 8; i += 8) {
+		__m128i g = _mm_loadu_si128((const __m128i*)(gallery + i));
+		acc = chi_square_step(acc, _mm_loadu_ps(probe + i), _mm_cvtepi32_ps(_mm_unpacklo_epi16(g, zero)));
+		acc = chi_square_step(acc, _mm_loadu_ps(probe + i + 4), _mm_cvtepi32_ps(_mm_unpackhi_epi16(g, zero)));
+	}
+	result = horizontal_sum(acc);
+#endif
+	for(; i < n; i++) {
+		result += chi_square_bin(probe[i], (float)gallery[i]);
+	}
+	return result;
+}
+
+// Scores a block of gallery rows; each row only writes its own distance.
+class ChiSquareRows : public ParallelLoopBody {
+public:
+	ChiSquareRows(const float* probe, const Mat& gallery, float* distances)
+		: probe(probe), gallery(gallery), distances(distances) {}
+
+	void operator()(const Range& range) const {
+		int n = gallery.cols;
+		if(gallery.type() == CV_32FC1) {
+			for(int i = range.start; i < range.end; i++) {
+				distances[i] = lbp::chi_square_f32(probe, gallery.ptr<float>(i), n);
+			}
+		} else {
+			for(int i = range.start; i < range.end; i++) {
+				distances[i] = lbp::chi_square_u16(probe, gallery.ptr<unsigned short>(i), n);
+			}
+		}
+	}
+
+private:
+	const float* probe;
+	const Mat& gallery;
+	float* distances;
+};
+
+void lbp::chi_square_batch(const Mat& probe, const Mat& gallery, Mat& distances) {
+	if(gallery.type() != CV_32FC1 && gallery.type() != CV_16UC1)
+		CV_Error(CV_StsBadArg, "Gallery must be CV_32FC1 or CV_16UC1.");
+	if(probe.total() != (size_t)gallery.cols)
+		CV_Error(CV_StsBadArg, "Probe and gallery histograms must be of equal dimension.");
+
+	Mat query;
+	if(probe.type() == CV_32FC1 && probe.isContinuous())
+		query = probe;
+	else
+		probe.convertTo(query, CV_32F);
+
+	distances.create(1, gallery.rows, CV_32FC1);
+	ChiSquareRows body(query.ptr<float>(0), gallery, distances.ptr<float>(0));
+	if(gallery.rows < CHI_SQUARE_PARALLEL_MIN_ROWS)
+		body(Range(0, gallery.rows));
+	else
+		parallel_for_(Range(0, gallery.rows), body);
+}
+
+static bool closer(const lbp::Match& a, const lbp::Match& b) {
+	return a.distance < b.distance || (a.distance == b.distance && a.index < b.index);
+}
+
+void lbp::top_k(const Mat& distances, int k, vector<Match>& matches) {
+	int n = (int)distances.total();
+	k = min(k, n);
+	const float* d = distances.ptr<float>(0);
+
+	matches.resize(n);
+	for(int i = 0; i < n; i++) {
+		matches[i].index = i;
+		matches[i].distance = d[i];
+	}
+	partial_sort(matches.begin(), matches.begin() + max(k, 0), matches.end(), closer);
+	matches.resize(max(k, 0));
+}
+
+void lbp::chi_square_top_k(const Mat& probe, const Mat& gallery, int k, vector<Match>& matches) {
+	Mat distances;
+	chi_square_batch(probe, gallery, distances);
+	top_k(distances, k, matches);
+}
@@ -0,0 +1,35 @@
+#ifndef CHISQUARE_H_
+#define CHISQUARE_H_
+
+#include <opencv2/core/core.hpp>
+
+#include <vector>
+
+using namespace cv;
+using namespace std;
+
+namespace lbp {
+
+// one gallery entry returned by chi_square_top_k
+struct Match {
+	int index;
+	float distance;
+};
+
+// Chi-square distance between a float probe and one gallery row of n bins.
+float chi_square_f32(const float* probe, const float* gallery, int n);
+float chi_square_u16(const float* probe, const unsigned short* gallery, int n);
+
+// Scores the probe (1 x d) against every row of gallery (N x d, CV_32FC1 or
+// CV_16UC1) and writes the N distances into a 1 x N CV_32FC1 row. Large
+// galleries are split across threads.
+void chi_square_batch(const Mat& probe, const Mat& gallery, Mat& distances);
+
+// Same as chi_square_batch, but only keeps the k closest rows, nearest first.
+void chi_square_top_k(const Mat& probe, const Mat& gallery, int k, vector<Match>& matches);
+
+// Picks the k smallest entries of a 1 x N CV_32FC1 distance row.
+void top_k(const Mat& distances, int k, vector<Match>& matches);
+
+}
+#endif
@@ -0,0 +1,356 @@
+/*
+ * classifierpolicy.h
+ */
+
+#ifndef CLASSIFIERPOLICY_H_
+#define CLASSIFIERPOLICY_H_
+
+#include <opencv2/core/core.hpp>
+
+#include <cfloat>
+#include <vector>
+
+#include "modelbundle.h"
+#include "svmmodel.h"
+#include "linearsvm.h"
+#include "rbfevaluator.h"
+#include "featuremap.h"
+#include "svmcascade.h"
+
+using namespace cv;
+using namespace std;
+
+// Classifier policies for LearnOnAndroid::__score_windows(). The scanner is
+// a template over them, so each backend is a direct, inlinable call rather
+// than a virtual one; __classify_windows picks the policy once per frame. A
+// policy provides
+//
+//   int dimension() const;
+//   bool normalized() const;
+//   void score(const float* descriptors, int n, float* out);
+//
+// where descriptors are n window descriptors of dimension() floats, back to
+// back, standardised with mean.txt and std.txt first when normalized() is
+// true, and out receives one score per window, above the scan's score
+// threshold for a face. A policy of dimension() 0 reads no descriptors (the
+// cascade finds its own cells) and gets NULL.
+//
+// The RBF policies evaluate SvmModel, which sums the kernels in double
+// precision; CvSVM::predict sums them in float, so a window right on the
+// decision boundary can come out differently than it did with CvSVM.
+
+// What the linear pre-filter did, see PrefilterPolicy.
+struct PrefilterStatistics {
+	int scanned;
+	int rejected;
+	int positives;
+	int missed;
+};
+
+// Exact RBF: projection of the batch, then the full decision function.
+class RbfPolicy {
+
+private:
+	const ModelBundle& bundle;
+	Mat projected;
+
+public:
+	RbfPolicy(const ModelBundle& bundle) : bundle(bundle) {
+	}
+
+	int dimension() const {
+		return this->bundle.projection.get_input_dimension();
+	}
+
+	// the bundle carries its own normalisation
+	bool normalized() const {
+		return false;
+	}
+
+	void score(const float* descriptors, int n, float* out) {
+		Mat batch(n, this->dimension(), CV_32FC1, (void*) descriptors);
+		this->bundle.projection.apply(batch, this->projected);
+		for (int i = 0; i < n; i++) {
+			out[i] = (float) this->bundle.svm.face_score(this->projected.ptr<float>(i));
+		}
+	}
+
+};
+
+// Linear SVM, relative to its calibrated threshold.
+class LinearPolicy {
+
+private:
+	const ModelBundle& bundle;
+	Mat projected;
+
+public:
+	LinearPolicy(const ModelBundle& bundle) : bundle(bundle) {
+	}
+
+	int dimension() const {
+		return this->bundle.projection.get_input_dimension();
+	}
+
+	bool normalized() const {
+		return false;
+	}
+
+	void score(const float* descriptors, int n, float* out) {
+		Mat batch(n, this->dimension(), CV_32FC1, (void*) descriptors);
+		this->bundle.projection.apply(batch, this->projected);
+		for (int i = 0; i < n; i++) {
+			out[i] = this->bundle.linear.score(this->projected.ptr<float>(i)) - this->bundle.linear.threshold;
+		}
+	}
+
+};
+
+// Intersection-kernel lookup tables on the raw descriptors.
+class IntersectionPolicy {
+
+private:
+	const IntersectionSvm& model;
+
+public:
+	IntersectionPolicy(const IntersectionSvm& model) : model(model) {
+	}
+
+	int dimension() const {
+		return this->model.get_var_count();
+	}
+
+	bool normalized() const {
+		return false;
+	}
+
+	void score(const float* descriptors, int n, float* out) {
+		int d = this->dimension();
+		for (int i = 0; i < n; i++) {
+			out[i] = this->model.score(descriptors + i*d);
+		}
+	}
+
+};
+
+// Int8 RBF, quantizing the raw descriptors itself.
+class QuantizedPolicy {
+
+private:
+	const QuantizedSvm& model;
+
+public:
+	QuantizedPolicy(const QuantizedSvm& model) : model(model) {
+	}
+
+	int dimension() const {
+		return this->model.var_count;
+	}
+
+	bool normalized() const {
+		return false;
+	}
+
+	void score(const float* descriptors, int n, float* out) {
+		int d = this->dimension();
+		for (int i = 0; i < n; i++) {
+			out[i] = this->model.face_score(descriptors + i*d);
+		}
+	}
+
+};
+
+// The RBF model of svm_model.xml, the default.
+class SvmPolicy {
+
+private:
+	const SvmModel& model;
+
+public:
+	SvmPolicy(const SvmModel& model) : model(model) {
+	}
+
+	int dimension() const {
+		return this->model.var_count;
+	}
+
+	bool normalized() const {
+		return true;
+	}
+
+	void score(const float* descriptors, int n, float* out) {
+		int d = this->dimension();
+		for (int i = 0; i < n; i++) {
+			out[i] = (float) this->model.face_score(descriptors + i*d);
+		}
+	}
+
+};
+
+// Early-exit evaluation of the same RBF model against the scan's score
+// threshold. Windows far from it score the bound that settled them, not
+// their face score.
+class EarlyExitPolicy {
+
+private:
+	const RbfEvaluator& evaluator;
+	double threshold;
+
+public:
+	EarlyExitPolicy(const RbfEvaluator& evaluator, double threshold) : evaluator(evaluator), threshold(threshold) {
+	}
+
+	int dimension() const {
+		return this->evaluator.get_model().var_count;
+	}
+
+	bool normalized() const {
+		return true;
+	}
+
+	void score(const float* descriptors, int n, float* out) {
+		int d = this->dimension();
+		for (int i = 0; i < n; i++) {
+			out[i] = (float) this->evaluator.face_score(descriptors + i*d, this->threshold);
+		}
+	}
+
+};
+
+// Explicit feature map of the RBF model, the whole batch in one product.
+class FeatureMapPolicy {
+
+private:
+	const FeatureMap& map;
+	Mat decisions;
+
+public:
+	FeatureMapPolicy(const FeatureMap& map) : map(map) {
+	}
+
+	int dimension() const {
+		return this->map.get_var_count();
+	}
+
+	bool normalized() const {
+		return true;
+	}
+
+	void score(const float* descriptors, int n, float* out) {
+		Mat batch(n, this->dimension(), CV_32FC1, (void*) descriptors);
+		this->map.decision(batch, this->decisions);
+		float sign = this->map.class_labels[0] == 1 ? 1.0f : -1.0f;
+		for (int i = 0; i < n; i++) {
+			out[i] = sign*this->decisions.at<float>(i);
+		}
+	}
+
+};
+
+// Coarse-to-fine SVM cascade over the windows of the scanned image; it
+// extracts each stage's descriptor itself. A window a stage rejects scores
+// -FLT_MAX, below any threshold; the others score their last stage.
+class CascadePolicy {
+
+private:
+	SvmCascade& cascade;
+	const Mat& image;
+	const vector<Point>& corners;
+	int box_size;
+
+public:
+	CascadePolicy(SvmCascade& cascade, const Mat& image, const vector<Point>& corners, int box_size)
+		: cascade(cascade), image(image), corners(corners), box_size(box_size) {
+	}
+
+	int dimension() const {
+		return 0;
+	}
+
+	bool normalized() const {
+		return false;
+	}
+
+	void score(const float*, int n, float* out) {
+		for (int i = 0; i < n; i++) {
+			const Point& corner = this->corners[i];
+			double face_score = 0.0;
+			bool face = this->cascade.classify(this->image, corner.x, corner.y, this->box_size, &face_score);
+			out[i] = face ? (float) face_score : -FLT_MAX;
+		}
+	}
+
+};
+
+// A linear pre-filter in front of another policy on the same normalised
+// descriptors. Only the windows it accepts reach the inner policy, gathered
+// into one batch; the rejected ones score -FLT_MAX. With the audit on the
+// inner policy scores every window, and the faces it finds among the
+// rejected ones are counted as missed.
+template <class Inner>
+class PrefilterPolicy {
+
+private:
+	const LinearSvm& prefilter;
+	Inner& inner;
+	PrefilterStatistics& statistics;
+	bool audit;
+	float threshold;
+	vector<float> kept;
+	vector<int> index;
+	vector<float> scores;
+
+public:
+	PrefilterPolicy(const LinearSvm& prefilter, Inner& inner, PrefilterStatistics& statistics,
+					bool audit, float threshold)
+		: prefilter(prefilter), inner(inner), statistics(statistics), audit(audit), threshold(threshold) {
+	}
+
+	int dimension() const {
+		return this->inner.dimension();
+	}
+
+	bool normalized() const {
+		return true;
+	}
+
+	void score(const float* descriptors, int n, float* out) {
+
+		int d = this->dimension();
+
+		this->kept.clear();
+		this->index.clear();
+		for (int i = 0; i < n; i++) {
+			const float* x = descriptors + i*d;
+			bool accepted = this->prefilter.accept(x);
+			if (accepted || this->audit) {
+				this->kept.insert(this->kept.end(), x, x + d);
+				this->index.push_back(accepted ? i : -1 - i);
+			}
+			if (!accepted) {
+				this->statistics.rejected++;
+				out[i] = -FLT_MAX;
+			}
+		}
+		this->statistics.scanned += n;
+
+		int m = (int) this->index.size();
+		this->scores.resize(m);
+		if (m > 0)
+			this->inner.score(&this->kept[0], m, &this->scores[0]);
+
+		for (int j = 0; j < m; j++) {
+			bool face = this->scores[j] > this->threshold;
+			if (this->audit)
+				this->statistics.positives += face;
+			if (this->index[j] >= 0) {
+				out[this->index[j]] = this->scores[j];
+			} else if (face) {
+				this->statistics.missed++;
+			}
+		}
+	}
+
+};
+
+#endif /* CLASSIFIERPOLICY_H_ */
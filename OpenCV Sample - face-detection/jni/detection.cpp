@@ -0,0 +1,84 @@
+/*
+ * detection.cpp
+ */
+
+#include "detection.h"
+
+#include <string.h>
+
+static double overlap(const Rect& a, const Rect& b) {
+
+	double intersection = (a & b).area();
+	double united = a.area() + b.area() - intersection;
+
+	return united > 0 ? intersection/united : 0.0;
+}
+
+TrackAssigner::TrackAssigner() {
+
+	this->next_track = 0;
+
+}
+
+TrackAssigner::~TrackAssigner() {
+}
+
+void TrackAssigner::assign(vector<Detection>& detections) {
+
+	// greedy, a previous track goes to at most one detection; the vectors
+	// keep their capacity from frame to frame
+	this->taken.assign(this->previous.size(), 0);
+
+	for (size_t i = 0; i < detections.size(); i++) {
+
+		int best = -1;
+		double best_overlap = TRACK_MIN_OVERLAP;
+
+		for (size_t j = 0; j < this->previous.size(); j++) {
+			double o = overlap(detections[i].box, this->previous[j].box);
+			if (!this->taken[j] && o >= best_overlap) {
+				best = (int) j;
+				best_overlap = o;
+			}
+		}
+
+		if (best >= 0) {
+			this->taken[best] = 1;
+			detections[i].track = this->previous[best].track;
+		} else {
+			detections[i].track = this->next_track++;
+		}
+	}
+
+	this->previous = detections;
+}
+
+void TrackAssigner::reset() {
+	this->previous.clear();
+}
+
+int write_detections(const vector<Detection>& detections, int sequence, void* buffer, size_t capacity) {
+
+	if (buffer == NULL || capacity < RESULT_HEADER_BYTES)
+		return 0;
+
+	int count = (int) detections.size();
+	int room = (int) ((capacity - RESULT_HEADER_BYTES)/RESULT_RECORD_BYTES);
+	if (count > room)
+		count = room;
+
+	char* out = (char*) buffer;
+	memcpy(out, &sequence, 4);
+	memcpy(out + 4, &count, 4);
+	out += RESULT_HEADER_BYTES;
+
+	for (int i = 0; i < count; i++) {
+		const Detection& d = detections[i];
+		int record[7] = { d.box.x, d.box.y, d.box.width, d.box.height, 0, d.level, d.track };
+		memcpy(&record[4], &d.score, 4);
+		memcpy(out, record, RESULT_RECORD_BYTES);
+		out += RESULT_RECORD_BYTES;
+	}
+
+	return count;
+}
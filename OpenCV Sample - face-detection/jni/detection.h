@@ -0,0 +1,60 @@
+/*
+ * detection.h
+ */
+
+#ifndef DETECTION_H_
+#define DETECTION_H_
+
+#include <opencv2/core/core.hpp>
+
+#include <vector>
+
+// a detection keeps the track of the previous frame's detection it
+// overlaps most, if the overlap (intersection over union) is at least this
+#define TRACK_MIN_OVERLAP 0.3
+
+// Result buffer layout, little endian as the device (DetectionBasedTracker.
+// java reads it with the same offsets):
+//   int32 sequence, int32 count, then count records of
+//   int32 x, y, width, height, float32 score, int32 level, int32 track
+#define RESULT_HEADER_BYTES 8
+#define RESULT_RECORD_BYTES 28
+
+using namespace cv;
+using namespace std;
+
+// One face found in a frame, in camera pixels. score is the classifier's
+// face score (0 from the OpenCV cascade), level the pyramid level it was
+// found at (-1 from the cascade).
+struct Detection {
+	Rect box;
+	float score;
+	int level;
+	int track;
+};
+
+// Gives each detection the track id of the previous frame's detection it
+// overlaps, or a new id.
+class TrackAssigner {
+
+private:
+	vector<Detection> previous;
+	vector<char> taken;
+	int next_track;
+
+public:
+	TrackAssigner();
+
+	virtual ~TrackAssigner();
+
+	void assign(vector<Detection>& detections);
+
+	void reset();
+
+};
+
+// Writes the header and as many records as fit into buffer; returns the
+// number of records written.
+int write_detections(const vector<Detection>& detections, int sequence, void* buffer, size_t capacity);
+
+#endif /* DETECTION_H_ */
@@ -0,0 +1,137 @@
+/*
+ * detectormodels.cpp
+ */
+
+#include "detectormodels.h"
+
+#include <fstream>
+
+#include <unistd.h>
+
+#ifdef EMBEDDED_MODEL
+#include "embedded_model.h"
+#endif
+
+static bool readable(const string& filename) {
+	return access(filename.c_str(), R_OK) == 0;
+}
+
+DetectorModels::DetectorModels() {
+}
+
+DetectorModels::~DetectorModels() {
+}
+
+void DetectorModels::load(string directory) {
+
+	string classification_model = directory + "svm_model.xml";
+	string mean_vector = directory + "mean.txt";
+	string std_vector = directory + "std.txt";
+
+	// an embedded model carries its own mean and std, see tools/embed_model.cpp
+#ifndef EMBEDDED_MODEL
+	this->svm.load(classification_model);
+	load_text_vector(mean_vector, this->mean);
+	load_text_vector(std_vector, this->deviation);
+
+	// clustering the support vectors takes a while, the loading thread
+	// does it once instead of every frame
+	if (readable(directory + "early_exit.txt")) {
+		ifstream fin((directory + "early_exit.txt").c_str());
+		int clusters = RBF_DEFAULT_CLUSTERS;
+		if (!(fin >> clusters))
+			clusters = RBF_DEFAULT_CLUSTERS;
+		this->early_exit.set_model(this->svm, clusters);
+	}
+#endif
+
+	// a model bundle, see tools/make_bundle.cpp and tools/train_projected.cpp,
+	// carries its own normalisation and picks the classifier backend
+	if (readable(directory + "bundle.xml"))
+		this->bundle.load(directory + "bundle.xml");
+
+	// a linearised RBF model, see tools/feature_map.cpp, scores all windows
+	// of a frame in one batch; it takes the normalised descriptor
+	if (readable(directory + "feature_map.xml")) {
+		this->feature_map.load(directory + "feature_map.xml");
+#ifdef EMBEDDED_MODEL
+		if (this->feature_map.get_var_count() != EMBEDDED_VAR_COUNT)
+#else
+		if (this->feature_map.get_var_count() != this->svm.var_count)
+#endif
+			CV_Error(CV_StsBadArg, "The feature map does not fit the SVM model's descriptor");
+	}
+
+	// an intersection-kernel model, see tools/train_intersection.cpp,
+	// replaces the RBF model when present
+	if (readable(directory + "intersection.xml"))
+		this->intersection.load(directory + "intersection.xml");
+
+	// the linear pre-filter is optional, see tools/train_prefilter.cpp; it
+	// screens the windows of the RBF model and takes the same descriptor
+	if (readable(directory + "prefilter.xml")) {
+#ifdef EMBEDDED_MODEL
+		this->prefilter.load(directory + "prefilter.xml", EMBEDDED_VAR_COUNT);
+#else
+		this->prefilter.load(directory + "prefilter.xml", this->svm.var_count);
+#endif
+	}
+
+	// a coarse-to-fine cascade, e.g. of the 58-d and the 232-d models in
+	// classifiers_/ and classifiers/, takes over when present, see svmcascade.h
+	if (readable(directory + "cascade.xml"))
+		this->cascade.load(directory + "cascade.xml");
+}
+
+void DetectorModels::load(const char* bundle, size_t length) {
+	this->bundle.load(bundle, length);
+}
+
+void DetectorModels::load(const ModelData& data) {
+
+	if (!data.bundle.empty()) {
+		this->load(data.bundle.data(), data.bundle.size());
+	} else {
+#ifndef EMBEDDED_MODEL
+		if (data.mean.empty() || data.deviation.empty())
+			CV_Error(CV_StsBadArg, "The SVM model needs its mean and std vectors");
+
+		this->svm.load(data.model.data(), data.model.size());
+		load_text_vector(data.mean.data(), data.mean.size(), this->mean);
+		load_text_vector(data.deviation.data(), data.deviation.size(), this->deviation);
+#endif
+	}
+
+	if (!data.intersection.empty())
+		this->intersection.load(data.intersection.data(), data.intersection.size());
+
+	if (!data.prefilter.empty()) {
+#ifdef EMBEDDED_MODEL
+		this->prefilter.load(data.prefilter.data(), data.prefilter.size(), EMBEDDED_VAR_COUNT);
+#else
+		this->prefilter.load(data.prefilter.data(), data.prefilter.size(), this->svm.var_count);
+#endif
+	}
+}
+
+int DetectorModels::descriptor_dimension() const {
+
+	// the order LearnOnAndroid::__classify_windows picks a classifier in
+	if (!this->cascade.empty())
+		return 0;
+
+#ifdef EMBEDDED_MODEL
+	return EMBEDDED_VAR_COUNT;
+#else
+	if (!this->bundle.empty())
+		return this->bundle.get_descriptor_dimension();
+
+	if (!this->feature_map.empty())
+		return this->feature_map.get_var_count();
+
+	if (!this->intersection.empty())
+		return this->intersection.get_var_count();
+
+	return this->svm.var_count;
+#endif
+}
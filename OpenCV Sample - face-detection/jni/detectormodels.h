@@ -0,0 +1,84 @@
+/*
+ * detectormodels.h
+ */
+
+#ifndef DETECTORMODELS_H_
+#define DETECTORMODELS_H_
+
+#include <opencv2/core/core.hpp>
+
+#include <string>
+
+#include "svmmodel.h"
+#include "linearsvm.h"
+#include "intersectionsvm.h"
+#include "svmcascade.h"
+#include "rbfevaluator.h"
+#include "featuremap.h"
+#include "modelbundle.h"
+
+using namespace cv;
+using namespace std;
+
+// Model files read into memory, e.g. from assets aapt stored compressed:
+// a bundle, or svm_model.xml, mean.txt and std.txt, and optionally
+// prefilter.xml and intersection.xml. Empty ones are unused. A cascade.xml
+// names its stages' files, so it is only read from the model directory.
+struct ModelData {
+	string bundle;
+	string model;
+	string mean;
+	string deviation;
+	string prefilter;
+	string intersection;
+
+	bool empty() const {
+		return this->bundle.empty() && this->model.empty();
+	}
+};
+
+// The models the LBP-SVM scan uses, read once and then handed to every
+// frame's LearnOnAndroid, which only copies Mat headers.
+//
+// load() looks in a directory for the files nativeMyDetector used to read
+// on every frame: svm_model.xml, mean.txt and std.txt, and optionally
+// bundle.xml, feature_map.xml, intersection.xml, prefilter.xml and
+// cascade.xml, which switches to the SVM cascade (svmcascade.h). An
+// early_exit.txt turns on the early-exit evaluation of the RBF model
+// (rbfevaluator.h); it holds the number of support vector clusters, or
+// nothing for the default.
+class DetectorModels {
+
+public:
+	SvmModel svm;
+	RbfEvaluator early_exit;
+	Mat mean;
+	Mat deviation;
+	LinearSvm prefilter;
+	IntersectionSvm intersection;
+	SvmCascade cascade;
+	FeatureMap feature_map;
+	ModelBundle bundle;
+
+public:
+	DetectorModels();
+
+	virtual ~DetectorModels();
+
+	void load(string directory);
+
+	// Only a model bundle, from memory (see mappedfile.h): it carries the
+	// model and its normalisation, nothing is read from the sdcard.
+	void load(const char* bundle, size_t length);
+
+	// The bundle if there is one, else the three default model files, and
+	// the optional models as load(directory) takes them.
+	void load(const ModelData& data);
+
+	// Length of the window descriptor the scan will classify with these
+	// models, 0 when any will do (the cascade picks its own cells).
+	int descriptor_dimension() const;
+
+};
+
+#endif /* DETECTORMODELS_H_ */
@@ -0,0 +1,290 @@
+/*
+ * detectorsession.cpp
+ */
+
+#include "detectorsession.h"
+
+#include <android/log.h>
+#include <unistd.h>
+
+#define LOG_TAG "FaceDetection/DetectorSession"
+#define LOGD(...) ((void)__android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__))
+
+DetectorSession::DetectorSession(string cascade, int face_size, string model_directory) {
+
+	DetectionBasedTracker::Parameters parameters;
+	if (face_size > 0)
+		parameters.minObjectSize = face_size;
+	this->tracker = new DetectionBasedTracker(cascade, parameters);
+	this->face_size = face_size;
+
+	this->model_directory = model_directory;
+
+	try {
+		this->__start_loader();
+	} catch (...) {
+		delete this->tracker;
+		throw;
+	}
+}
+
+DetectorSession::DetectorSession(const char* cascade, size_t cascade_length, int face_size, string model_directory,
+								 int bundle_fd, off_t bundle_offset, size_t bundle_length) {
+
+	this->tracker = NULL;
+	this->face_size = face_size;
+
+	this->__read_cascade(cascade, cascade_length);
+
+	this->model_directory = model_directory;
+
+	// mapping is cheap, the pages are read by the loading thread
+	if (bundle_fd >= 0)
+		this->bundle_file.map(bundle_fd, bundle_offset, bundle_length);
+
+	this->__start_loader();
+}
+
+DetectorSession::DetectorSession(const char* cascade, size_t cascade_length, int face_size, string model_directory,
+								 const ModelData& models) {
+
+	this->tracker = NULL;
+	this->face_size = face_size;
+
+	this->__read_cascade(cascade, cascade_length);
+
+	this->model_directory = model_directory;
+	this->model_data = models;
+
+	this->__start_loader();
+}
+
+void DetectorSession::__read_cascade(const char* cascade, size_t cascade_length) {
+
+	// the cascade is small and needed for the first frame, parse it here
+	FileStorage fs(string(cascade, cascade_length), FileStorage::READ + FileStorage::MEMORY);
+	if (!fs.isOpened() || !this->cascade.read(fs.getFirstTopLevelNode()))
+		CV_Error(CV_StsParseError, "Could not read the cascade");
+}
+
+DetectorSession::~DetectorSession() {
+
+	this->__join_loader();
+	pthread_mutex_destroy(&this->lock);
+
+	// no frame can hold a reference once Java destroys the object, the
+	// models go with this->models
+	delete this->tracker;
+}
+
+void DetectorSession::__start_loader() {
+
+	this->result_buffer = NULL;
+	this->result_capacity = 0;
+	this->sequence = 0;
+	this->prefilter_audit = false;
+
+	this->loading = true;
+	this->load_state = MODEL_LOADING;
+	this->load_milliseconds = 0.0;
+
+	pthread_mutex_init(&this->lock, NULL);
+
+	this->loader_joinable = false;
+	if (pthread_create(&this->loader, NULL, DetectorSession::__load, this) != 0) {
+		pthread_mutex_destroy(&this->lock);
+		CV_Error(CV_StsError, "Could not start the model loading thread");
+	}
+	this->loader_joinable = true;
+}
+
+void DetectorSession::__join_loader() {
+
+	if (this->loader_joinable) {
+		pthread_join(this->loader, NULL);
+		this->loader_joinable = false;
+	}
+}
+
+void DetectorSession::publish_detections() {
+
+	this->tracks.assign(this->detections);
+
+	write_detections(this->detections, ++this->sequence, this->result_buffer, this->result_capacity);
+}
+
+void DetectorSession::set_scan_parameters(const ScanParameters& parameters) {
+
+	{
+		ModelReference models(this);
+		parameters.validate(models.get() != NULL ? models.get()->descriptor_dimension() : 0);
+	}
+
+	pthread_mutex_lock(&this->lock);
+	this->parameters = parameters;
+	pthread_mutex_unlock(&this->lock);
+}
+
+ScanParameters DetectorSession::get_scan_parameters() {
+
+	pthread_mutex_lock(&this->lock);
+	ScanParameters parameters = this->parameters;
+	pthread_mutex_unlock(&this->lock);
+
+	return parameters;
+}
+
+bool DetectorSession::swap_models(string bundle) {
+
+	pthread_mutex_lock(&this->lock);
+	if (this->loading) {
+		pthread_mutex_unlock(&this->lock);
+		return false;
+	}
+	this->loading = true;
+	this->load_state = MODEL_LOADING;
+	pthread_mutex_unlock(&this->lock);
+
+	// the previous loading thread is done, joining it does not wait; if
+	// the previous swap could not start one there is nothing to join
+	this->__join_loader();
+
+	this->bundle_path = bundle;
+
+	if (pthread_create(&this->loader, NULL, DetectorSession::__load, this) != 0) {
+		this->__finish_loading(MODEL_FAILED, 0.0, "Could not start the model loading thread");
+		return false;
+	}
+	this->loader_joinable = true;
+
+	return true;
+}
+
+void DetectorSession::start() {
+	if (this->tracker != NULL)
+		this->tracker->run();
+}
+
+void DetectorSession::stop() {
+	if (this->tracker != NULL)
+		this->tracker->stop();
+}
+
+void DetectorSession::set_face_size(int face_size) {
+
+	if (face_size <= 0)
+		return;
+
+	this->face_size = face_size;
+
+	pthread_mutex_lock(&this->lock);
+	this->parameters.min_face_size = face_size;
+	if (this->parameters.max_face_size > 0 && this->parameters.max_face_size < face_size)
+		this->parameters.max_face_size = 0;
+	pthread_mutex_unlock(&this->lock);
+
+	if (this->tracker != NULL) {
+		DetectionBasedTracker::Parameters parameters = this->tracker->getParameters();
+		parameters.minObjectSize = face_size;
+		this->tracker->setParameters(parameters);
+	}
+}
+
+void DetectorSession::detect(const Mat& gray, vector<Rect>& faces) {
+
+	if (this->tracker != NULL) {
+		this->tracker->process(gray);
+		this->tracker->getObjects(faces);
+		return;
+	}
+
+	// the parameters FdActivity's Java detector used
+	this->cascade.detectMultiScale(gray, faces, 1.1, 2, CV_HAAR_SCALE_IMAGE,
+								   Size(this->face_size, this->face_size));
+}
+
+int DetectorSession::state() {
+
+	pthread_mutex_lock(&this->lock);
+	int state = this->load_state;
+	pthread_mutex_unlock(&this->lock);
+
+	return state;
+}
+
+double DetectorSession::get_load_milliseconds() {
+
+	pthread_mutex_lock(&this->lock);
+	double milliseconds = this->load_milliseconds;
+	pthread_mutex_unlock(&this->lock);
+
+	return milliseconds;
+}
+
+string DetectorSession::get_load_error() {
+
+	pthread_mutex_lock(&this->lock);
+	string error = this->load_error;
+	pthread_mutex_unlock(&this->lock);
+
+	return error;
+}
+
+void* DetectorSession::__load(void* session) {
+
+	DetectorSession* self = (DetectorSession*) session;
+	int64 start = getTickCount();
+
+	DetectorModels* fresh = new DetectorModels();
+
+	try {
+		if (!self->bundle_path.empty()) {
+			self->bundle_file.map(self->bundle_path);
+			fresh->load(self->bundle_file.data(), self->bundle_file.size());
+		} else if (!self->bundle_file.empty()) {
+			fresh->load(self->bundle_file.data(), self->bundle_file.size());
+		} else if (!self->model_data.empty()) {
+			fresh->load(self->model_data);
+		} else {
+			fresh->load(self->model_directory);
+		}
+		self->bundle_file.release();
+		self->model_data = ModelData();
+	} catch (cv::Exception& e) {
+		self->bundle_file.release();
+		self->model_data = ModelData();
+		delete fresh;
+		double milliseconds = 1000.0*(getTickCount() - start)/getTickFrequency();
+		LOGD("model loading failed after %.1f ms: %s", milliseconds, e.what());
+		self->__finish_loading(MODEL_FAILED, milliseconds, e.what());
+		return NULL;
+	} catch (...) {
+		self->bundle_file.release();
+		self->model_data = ModelData();
+		delete fresh;
+		double milliseconds = 1000.0*(getTickCount() - start)/getTickFrequency();
+		LOGD("model loading failed after %.1f ms", milliseconds);
+		self->__finish_loading(MODEL_FAILED, milliseconds, "unknown exception");
+		return NULL;
+	}
+
+	double milliseconds = 1000.0*(getTickCount() - start)/getTickFrequency();
+	LOGD("model ready in %.1f ms", milliseconds);
+
+	// frames switch over on their next ModelReference, the old models are
+	// freed here once the frames still running on them are done
+	self->models.publish(fresh);
+	self->__finish_loading(MODEL_READY, milliseconds, "");
+
+	return NULL;
+}
+
+void DetectorSession::__finish_loading(int state, double milliseconds, string error) {
+
+	pthread_mutex_lock(&this->lock);
+	this->loading = false;
+	this->load_state = state;
+	this->load_milliseconds = milliseconds;
+	this->load_error = error;
+	pthread_mutex_unlock(&this->lock);
+}
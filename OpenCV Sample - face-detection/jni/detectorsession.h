@@ -0,0 +1,205 @@
+/*
+ * detectorsession.h
+ */
+
+#ifndef DETECTORSESSION_H_
+#define DETECTORSESSION_H_
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/objdetect/objdetect.hpp>
+#include <opencv2/contrib/detection_based_tracker.hpp>
+
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+#include "learnonandroid.h"
+#include "detectormodels.h"
+#include "epochpointer.h"
+#include "mappedfile.h"
+#include "scanparameters.h"
+#include "detection.h"
+
+// state of the most recent load, see DetectorSession::state()
+#define MODEL_LOADING 0
+#define MODEL_READY 1
+#define MODEL_FAILED 2
+
+using namespace cv;
+using namespace std;
+
+// What the Java side holds as the native detector: a cascade detector and
+// the LBP-SVM models. The models are read on a thread of their own, started
+// by the constructor, so nativeCreateObject returns as soon as the cascade
+// is usable; until the first models are published nativeMyDetector falls
+// back to detect().
+//
+// Built from a cascade file the session runs a DetectionBasedTracker, as
+// before. Built from a cascade in memory (DetectionBasedTracker only takes
+// a filename) it runs a plain CascadeClassifier, so start() and stop() do
+// nothing, and the models may come from a bundle mapped out of the APK or
+// from model files read into memory instead of the sdcard.
+//
+// swap_models() loads a model bundle on the same thread and publishes it
+// in place of the current models (epochpointer.h): frames take the models
+// through a ModelReference, which never waits, and the loading thread
+// frees the old models once the frames that may have seen them are done.
+//
+// The scan geometry can be changed between frames (set_scan_parameters);
+// the LBP-SVM scanner lives as long as the session, so its buffers are
+// kept from frame to frame and only grow when the geometry needs it.
+//
+// Each frame's faces go to Java through a direct ByteBuffer the Java side
+// owns and registers once (set_result_buffer), laid out as in detection.h.
+class DetectorSession {
+
+private:
+	DetectionBasedTracker* tracker;
+	CascadeClassifier cascade;
+	int face_size;
+
+	EpochPointer<DetectorModels> models;
+
+	ScanParameters parameters;
+	LearnOnAndroid scanner;
+	Mat blurred_frame;
+	volatile bool prefilter_audit;
+
+	void* result_buffer;
+	size_t result_capacity;
+	int sequence;
+	TrackAssigner tracks;
+	vector<Detection> detections;
+
+	string model_directory;
+	string bundle_path;
+	MappedFile bundle_file;
+	ModelData model_data;
+
+	pthread_t loader;
+	// set while loader is a thread nobody joined yet
+	bool loader_joinable;
+	pthread_mutex_t lock;
+	bool loading;
+	int load_state;
+	double load_milliseconds;
+	string load_error;
+
+public:
+	DetectorSession(string cascade, int face_size, string model_directory);
+
+	// bundle_fd < 0 reads the models from model_directory
+	DetectorSession(const char* cascade, size_t cascade_length, int face_size, string model_directory,
+					int bundle_fd = -1, off_t bundle_offset = 0, size_t bundle_length = 0);
+
+	// empty model data reads the models from model_directory
+	DetectorSession(const char* cascade, size_t cascade_length, int face_size, string model_directory,
+					const ModelData& models);
+
+	virtual ~DetectorSession();
+
+	void start();
+
+	void stop();
+
+	void set_face_size(int face_size);
+
+	void detect(const Mat& gray, vector<Rect>& faces);
+
+	// Raises CV_StsBadArg if the parameters do not fit the current models.
+	void set_scan_parameters(const ScanParameters& parameters);
+
+	ScanParameters get_scan_parameters();
+
+	// Only for the frame thread.
+	LearnOnAndroid& get_scanner() {
+		return this->scanner;
+	}
+
+	// Only for the frame thread: the blurred camera frame, see
+	// ScanParameters::build_level.
+	Mat& get_blurred_frame() {
+		return this->blurred_frame;
+	}
+
+	// With the audit on, windows the linear pre-filter rejects still go
+	// through the RBF model, and the faces it loses are logged; costly,
+	// for measuring a pre-filter only.
+	void set_prefilter_audit(bool audit) {
+		this->prefilter_audit = audit;
+	}
+
+	bool get_prefilter_audit() const {
+		return this->prefilter_audit;
+	}
+
+	void set_result_buffer(void* buffer, size_t capacity) {
+		this->result_buffer = buffer;
+		this->result_capacity = capacity;
+	}
+
+	// Only for the frame thread: the frame's detections, emptied here and
+	// filled by the caller, keep their capacity between frames.
+	vector<Detection>& begin_frame() {
+		this->detections.clear();
+		return this->detections;
+	}
+
+	// Gives the detections track ids and writes them to the result buffer
+	// under the next sequence number.
+	void publish_detections();
+
+	// Starts loading a model bundle file; false if a load is still running.
+	bool swap_models(string bundle);
+
+	int state();
+
+	double get_load_milliseconds();
+
+	string get_load_error();
+
+private:
+	friend class ModelReference;
+
+	void __read_cascade(const char* cascade, size_t cascade_length);
+
+	void __start_loader();
+
+	void __join_loader();
+
+	static void* __load(void* session);
+
+	void __finish_loading(int state, double milliseconds, string error);
+
+};
+
+// The models a frame runs on, pinned until the reference goes out of scope.
+// get() is NULL while the first load is still running.
+class ModelReference {
+
+private:
+	DetectorSession* session;
+	const DetectorModels* models;
+	int slot;
+
+public:
+	ModelReference(DetectorSession* session) : session(session) {
+		this->models = session->models.acquire(this->slot);
+	}
+
+	~ModelReference() {
+		this->session->models.release(this->slot);
+	}
+
+	const DetectorModels* get() const {
+		return this->models;
+	}
+
+private:
+	ModelReference(const ModelReference&);
+
+	ModelReference& operator=(const ModelReference&);
+
+};
+
+#endif /* DETECTORSESSION_H_ */
@@ -0,0 +1,97 @@
+/*
+ * epochpointer.h
+ */
+
+#ifndef EPOCHPOINTER_H_
+#define EPOCHPOINTER_H_
+
+#include <stddef.h>
+#include <unistd.h>
+
+// Where a reader can be preempted between reading the epoch and counting
+// itself in; tests/model_swap_check.cpp stops a reader there.
+#ifndef EPOCH_POINTER_PREEMPTED
+#define EPOCH_POINTER_PREEMPTED()
+#endif
+
+// An object one writer replaces while readers go on using the one they
+// took, RCU style. Every publish flips an epoch; a reader counts itself in
+// the slot of the epoch it started in, and publish() frees the old object
+// once the count of the previous epoch drains. acquire() costs two atomic
+// adds and never waits on the writer; publish() waits for the readers.
+//
+// A reader preempted between reading the epoch and counting itself in may
+// wake up after a publish has already drained that slot. It would then
+// take the new object under the old slot, and the next publish, which
+// waits on the other slot, would free it under the reader. So acquire()
+// reads the epoch again once counted in, and counts in again if it moved.
+//
+// Only one thread may publish at a time.
+template<class T>
+class EpochPointer {
+
+private:
+	T* volatile object;
+	volatile int epoch;
+	volatile int readers[2];
+
+public:
+	EpochPointer() : object(NULL), epoch(0) {
+		this->readers[0] = 0;
+		this->readers[1] = 0;
+	}
+
+	// no reader may hold the object any more
+	virtual ~EpochPointer() {
+		delete this->object;
+	}
+
+	const T* acquire(int& slot) {
+
+		for (;;) {
+			int epoch = this->epoch;
+			EPOCH_POINTER_PREEMPTED();
+
+			slot = epoch & 1;
+			__sync_fetch_and_add(&this->readers[slot], 1);
+
+			// counted in before reading the pointer: a publish that comes
+			// later waits for this slot, one that came earlier moved the epoch
+			if (this->epoch == epoch)
+				return this->object;
+
+			__sync_fetch_and_sub(&this->readers[slot], 1);
+		}
+	}
+
+	void release(int slot) {
+		__sync_fetch_and_sub(&this->readers[slot], 1);
+	}
+
+	void publish(T* fresh) {
+
+		__sync_synchronize();
+		T* old = __sync_lock_test_and_set(&this->object, fresh);
+		int previous = __sync_fetch_and_add(&this->epoch, 1) & 1;
+
+		if (old == NULL)
+			return;
+
+		// readers counted in the previous epoch may still use the old
+		// object; readers starting from now count in the other slot
+		while (this->readers[previous] != 0) {
+			usleep(1000);
+		}
+		__sync_synchronize();
+
+		delete old;
+	}
+
+private:
+	EpochPointer(const EpochPointer&);
+
+	EpochPointer& operator=(const EpochPointer&);
+
+};
+
+#endif /* EPOCHPOINTER_H_ */
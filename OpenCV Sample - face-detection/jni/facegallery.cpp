@@ -0,0 +1,339 @@
+/*
+ * facegallery.cpp
+ */
+
+#include "facegallery.h"
+
+#include <cfloat>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "histogram.h"
+#include "lbp.h"
+#include "include/vl/lbp.hpp"
+
+#define GALLERY_VERSION 1
+
+static const char GALLERY_MAGIC[4] = {'L', 'B', 'P', 'G'};
+
+static int gallery_dimension() {
+	return GALLERY_GRID*GALLERY_GRID*GALLERY_PATTERNS;
+}
+
+static int gallery_record_size() {
+	int size = sizeof(GalleryRecord) + gallery_dimension()*sizeof(unsigned short);
+	return (size + 7) & ~7;
+}
+
+FaceGallery::FaceGallery() {
+
+	this->fd = -1;
+	this->mapping = NULL;
+	this->mapping_size = 0;
+
+	this->__set_uniform_lut();
+
+}
+
+FaceGallery::FaceGallery(string filename) {
+
+	this->fd = -1;
+	this->mapping = NULL;
+	this->mapping_size = 0;
+
+	this->__set_uniform_lut();
+	this->open(filename);
+
+}
+
+FaceGallery::~FaceGallery() {
+	this->close();
+}
+
+void FaceGallery::__set_uniform_lut() {
+
+	VlLbp* lbp_model = vl_lbp_new(VlLbpUniform, false);
+
+	this->uniform_lut.create(1, 256, CV_8UC1);
+	for (int i = 0; i < 256; i++) {
+		this->uniform_lut.at<uchar>(i) = lbp_model->mapping[i];
+	}
+
+	vl_lbp_delete(lbp_model);
+}
+
+void FaceGallery::open(string filename) {
+
+	this->close();
+	this->filename = filename;
+
+	this->fd = ::open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+	if (this->fd < 0)
+		CV_Error(CV_StsError, "Could not open the gallery file " + filename);
+
+	// a file that cannot be used is not kept open
+	try {
+		this->__load();
+	} catch (...) {
+		this->close();
+		throw;
+	}
+}
+
+void FaceGallery::__load() {
+
+	struct stat st;
+	if (fstat(this->fd, &st) != 0)
+		CV_Error(CV_StsError, "Could not stat the gallery file " + this->filename);
+
+	if (st.st_size == 0) {
+		this->__create();
+		return;
+	}
+
+	if ((size_t)st.st_size < sizeof(GalleryHeader))
+		CV_Error(CV_StsParseError, "Truncated gallery file " + this->filename);
+
+	this->__map(st.st_size);
+
+	GalleryHeader* header = this->__header();
+	if (memcmp(header->magic, GALLERY_MAGIC, 4) != 0 ||
+			header->version != GALLERY_VERSION ||
+			header->dimension != gallery_dimension() ||
+			header->record_size != gallery_record_size())
+		CV_Error(CV_StsParseError, "Incompatible gallery file " + this->filename);
+
+	// get_count() and get_live() bound every loop over the records
+	if (header->capacity < 0 || header->count < 0 || header->live < 0 ||
+			header->count > header->capacity || header->live > header->count ||
+			(size_t)st.st_size < sizeof(GalleryHeader) + (size_t)header->capacity*header->record_size)
+		CV_Error(CV_StsParseError, "Corrupt gallery file " + this->filename);
+}
+
+void FaceGallery::close() {
+
+	this->__unmap();
+
+	if (this->fd >= 0) {
+		::close(this->fd);
+		this->fd = -1;
+	}
+}
+
+void FaceGallery::__create() {
+
+	GalleryHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, GALLERY_MAGIC, 4);
+	header.version = GALLERY_VERSION;
+	header.dimension = gallery_dimension();
+	header.record_size = gallery_record_size();
+
+	if (pwrite(this->fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header))
+		CV_Error(CV_StsError, "Could not write the gallery file " + this->filename);
+
+	this->__map(sizeof(header));
+}
+
+void FaceGallery::__map(size_t size) {
+
+	this->__unmap();
+
+	void* address = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, this->fd, 0);
+	if (address == MAP_FAILED)
+		CV_Error(CV_StsError, "Could not map the gallery file " + this->filename);
+
+	this->mapping = (unsigned char*) address;
+	this->mapping_size = size;
+}
+
+void FaceGallery::__unmap() {
+
+	if (this->mapping != NULL) {
+		munmap(this->mapping, this->mapping_size);
+		this->mapping = NULL;
+		this->mapping_size = 0;
+	}
+}
+
+void FaceGallery::__grow() {
+
+	GalleryHeader* header = this->__header();
+	int capacity = header->capacity + GALLERY_GROW;
+	size_t size = sizeof(GalleryHeader) + (size_t)capacity*header->record_size;
+
+	if (ftruncate(this->fd, size) != 0)
+		CV_Error(CV_StsError, "Could not grow the gallery file " + this->filename);
+
+	this->__map(size);
+	this->__header()->capacity = capacity;
+}
+
+void FaceGallery::__sync() {
+	msync(this->mapping, this->mapping_size, MS_ASYNC);
+}
+
+GalleryHeader* FaceGallery::__header() const {
+	return (GalleryHeader*) this->mapping;
+}
+
+GalleryRecord* FaceGallery::__record(int id) const {
+	return (GalleryRecord*) (this->mapping + sizeof(GalleryHeader) +
+							 (size_t)id*this->__header()->record_size);
+}
+
+void FaceGallery::describe(const Mat& face, Mat& descriptor) {
+
+	Mat gray;
+
+	if (face.channels() == 4)
+		cvtColor(face, gray, CV_RGBA2GRAY);
+	else if (face.channels() == 3)
+		cvtColor(face, gray, CV_BGR2GRAY);
+	else
+		gray = face;
+
+	resize(gray, gray, Size(GALLERY_FACE_SIZE, GALLERY_FACE_SIZE));
+
+	Mat codes = Mat::zeros(gray.rows-2, gray.cols-2, CV_8UC1);
+	lbp::OLBP(gray, codes);
+	LUT(codes, this->uniform_lut, codes);
+
+	lbp::spatial_histogram(codes, descriptor, GALLERY_PATTERNS, GALLERY_GRID, GALLERY_GRID);
+}
+
+int FaceGallery::enroll(const Mat& face, int label) {
+
+	if (!this->is_open())
+		CV_Error(CV_StsError, "Gallery is not open");
+
+	Mat descriptor;
+	this->describe(face, descriptor);
+
+	GalleryHeader* header = this->__header();
+	int id = -1;
+
+	if (header->live < header->count) {
+		for (int i = 0; i < header->count; i++) {
+			if (!this->__record(i)->alive) {
+				id = i;
+				break;
+			}
+		}
+	}
+
+	if (id < 0) {
+		if (header->count == header->capacity) {
+			this->__grow();
+			header = this->__header();
+		}
+		id = header->count;
+	}
+
+	GalleryRecord* record = this->__record(id);
+	Mat row(1, header->dimension, CV_16UC1, record + 1);
+	descriptor.convertTo(row, CV_16U);
+
+	record->label = label;
+	record->alive = 1;
+
+	if (id == header->count)
+		header->count++;
+	header->live++;
+
+	this->__sync();
+
+	return id;
+}
+
+void FaceGallery::remove(int id) {
+
+	if (!this->is_open() || id < 0 || id >= this->get_count())
+		CV_Error(CV_StsOutOfRange, "No such gallery record");
+
+	GalleryRecord* record = this->__record(id);
+	if (record->alive) {
+		record->alive = 0;
+		this->__header()->live--;
+		this->__sync();
+	}
+}
+
+int FaceGallery::remove_label(int label) {
+
+	int removed = 0;
+
+	for (int i = 0; i < this->get_count(); i++) {
+		if (this->is_alive(i) && this->get_label(i) == label) {
+			this->remove(i);
+			removed++;
+		}
+	}
+
+	return removed;
+}
+
+void FaceGallery::identify(const Mat& face, int k, vector<GalleryMatch>& matches) {
+
+	matches.clear();
+
+	if (!this->is_open() || this->get_live() == 0)
+		return;
+
+	Mat descriptor;
+	Mat distances;
+	vector<lbp::Match> nearest;
+
+	this->describe(face, descriptor);
+	lbp::chi_square_batch(descriptor, this->get_descriptors(), distances);
+
+	float* d = distances.ptr<float>(0);
+	for (int i = 0; i < this->get_count(); i++) {
+		if (!this->is_alive(i))
+			d[i] = FLT_MAX;
+	}
+
+	lbp::top_k(distances, min(k, this->get_live()), nearest);
+
+	for (size_t i = 0; i < nearest.size(); i++) {
+		GalleryMatch match;
+		match.id = nearest[i].index;
+		match.label = this->get_label(match.id);
+		match.distance = nearest[i].distance;
+		matches.push_back(match);
+	}
+}
+
+int FaceGallery::get_dimension() const {
+	return gallery_dimension();
+}
+
+int FaceGallery::get_count() const {
+	return this->is_open() ? this->__header()->count : 0;
+}
+
+int FaceGallery::get_live() const {
+	return this->is_open() ? this->__header()->live : 0;
+}
+
+int FaceGallery::get_label(int id) const {
+	return this->__record(id)->label;
+}
+
+bool FaceGallery::is_alive(int id) const {
+	return this->__record(id)->alive != 0;
+}
+
+Mat FaceGallery::get_descriptors() const {
+
+	if (this->get_count() == 0)
+		return Mat();
+
+	// rows point straight into the mapping, one record apart
+	return Mat(this->get_count(), this->get_dimension(), CV_16UC1,
+			   this->__record(0) + 1, this->__header()->record_size);
+}
@@ -0,0 +1,122 @@
+/*
+ * facegallery.h
+ */
+
+#ifndef FACEGALLERY_H_
+#define FACEGALLERY_H_
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <string>
+#include <vector>
+
+#include "chisquare.h"
+
+// face crops are resized to this before the LBP codes are computed; the
+// 3x3 neighbourhood leaves a 96x96 code map, i.e. 12x12 pixels per cell
+#define GALLERY_FACE_SIZE 98
+#define GALLERY_GRID 8
+#define GALLERY_PATTERNS 58
+// records added to the file each time it runs out of free slots
+#define GALLERY_GROW 256
+
+using namespace cv;
+using namespace std;
+
+// On-disk layout: one GalleryHeader followed by capacity fixed size
+// records. A record holds the label, an alive flag and the spatial uniform
+// LBP histogram as uint16 counts. Enrolling fills a free record in place,
+// removing clears its alive flag, so neither rewrites the file.
+struct GalleryHeader {
+	char magic[4];
+	int version;
+	int dimension;
+	int record_size;
+	int capacity;
+	int count;
+	int live;
+	int reserved[9];
+};
+
+struct GalleryRecord {
+	int label;
+	int alive;
+	// followed by dimension unsigned shorts
+};
+
+struct GalleryMatch {
+	int id;
+	int label;
+	float distance;
+};
+
+class FaceGallery {
+
+private:
+	int fd;
+	unsigned char* mapping;
+	size_t mapping_size;
+	string filename;
+	Mat uniform_lut;
+
+public:
+	FaceGallery();
+
+	FaceGallery(string filename);
+
+	virtual ~FaceGallery();
+
+	void open(string filename);
+
+	void close();
+
+	bool is_open() const {
+		return this->mapping != NULL;
+	}
+
+	int enroll(const Mat& face, int label);
+
+	void remove(int id);
+
+	int remove_label(int label);
+
+	void identify(const Mat& face, int k, vector<GalleryMatch>& matches);
+
+	void describe(const Mat& face, Mat& descriptor);
+
+	int get_dimension() const;
+
+	int get_count() const;
+
+	int get_live() const;
+
+	int get_label(int id) const;
+
+	bool is_alive(int id) const;
+
+	Mat get_descriptors() const;
+
+private:
+
+	GalleryHeader* __header() const;
+
+	GalleryRecord* __record(int id) const;
+
+	void __load();
+
+	void __create();
+
+	void __map(size_t size);
+
+	void __unmap();
+
+	void __grow();
+
+	void __sync();
+
+	void __set_uniform_lut();
+
+};
+
+#endif /* FACEGALLERY_H_ */
@@ -0,0 +1,323 @@
+/*
+ * featuremap.cpp
+ */
+
+#include "featuremap.h"
+
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+// Nystrom landmarks, cv::kmeans with KMEANS_PP_CENTERS and 3 attempts
+// but drawing from rng: cv::kmeans only takes its seeds from theRNG(), and
+// fit() must not reseed the caller's RNG.
+static void landmark_centers(const Mat& samples, int k, RNG& rng, Mat& centers) {
+
+	const int attempts = 3;
+	const int iterations = 50;
+	const double epsilon = 1e-4;
+
+	int n = samples.rows;
+	double best = DBL_MAX;
+	vector<int> labels(n);
+	vector<double> nearest(n);
+
+	for (int a = 0; a < attempts; a++) {
+
+		// k-means++ seeding: each centre is a sample drawn with probability
+		// proportional to its squared distance to the nearest centre so far
+		Mat current(k, samples.cols, CV_32FC1);
+		samples.row(rng.uniform(0, n)).copyTo(current.row(0));
+		for (int i = 0; i < n; i++)
+			nearest[i] = norm(samples.row(i), current.row(0), NORM_L2SQR);
+
+		for (int c = 1; c < k; c++) {
+			double total = 0.0;
+			for (int i = 0; i < n; i++)
+				total += nearest[i];
+
+			double target = rng.uniform(0.0, total);
+			int pick = n - 1;
+			for (int i = 0; i < n; i++) {
+				target -= nearest[i];
+				if (target <= 0.0) {
+					pick = i;
+					break;
+				}
+			}
+
+			samples.row(pick).copyTo(current.row(c));
+			for (int i = 0; i < n; i++)
+				nearest[i] = min(nearest[i], norm(samples.row(i), current.row(c), NORM_L2SQR));
+		}
+
+		double compactness = 0.0;
+		for (int it = 0; it < iterations; it++) {
+
+			compactness = 0.0;
+			for (int i = 0; i < n; i++) {
+				double closest = DBL_MAX;
+				for (int c = 0; c < k; c++) {
+					double d = norm(samples.row(i), current.row(c), NORM_L2SQR);
+					if (d < closest) {
+						closest = d;
+						labels[i] = c;
+					}
+				}
+				compactness += closest;
+			}
+
+			Mat sums = Mat::zeros(k, samples.cols, CV_64FC1);
+			vector<int> counts(k, 0);
+			for (int i = 0; i < n; i++) {
+				Mat row;
+				samples.row(i).convertTo(row, CV_64F);
+				sums.row(labels[i]) += row;
+				counts[labels[i]]++;
+			}
+
+			// an empty cluster keeps its centre, as a sample it is exact
+			double moved = 0.0;
+			for (int c = 0; c < k; c++) {
+				if (counts[c] == 0)
+					continue;
+				Mat mean;
+				sums.row(c).convertTo(mean, CV_32F, 1.0/counts[c]);
+				moved = max(moved, norm(mean, current.row(c), NORM_L2SQR));
+				mean.copyTo(current.row(c));
+			}
+
+			if (moved <= epsilon*epsilon)
+				break;
+		}
+
+		if (compactness < best) {
+			best = compactness;
+			current.copyTo(centers);
+		}
+	}
+}
+
+FeatureMap::FeatureMap() {
+
+	this->type = FEATURE_MAP_FOURIER;
+	this->gamma = 0.0;
+	this->bias = 0.0;
+	this->class_labels[0] = -1;
+	this->class_labels[1] = 1;
+
+}
+
+FeatureMap::FeatureMap(string filename) {
+
+	this->type = FEATURE_MAP_FOURIER;
+	this->gamma = 0.0;
+	this->bias = 0.0;
+	this->class_labels[0] = -1;
+	this->class_labels[1] = 1;
+
+	this->load(filename);
+
+}
+
+FeatureMap::~FeatureMap() {
+}
+
+void FeatureMap::fit(const SvmModel& model, int type, int dimension, uint64 seed) {
+
+	if (model.kernel_type != CvSVM::RBF)
+		CV_Error(CV_StsBadArg, "Only RBF models need a feature map");
+
+	this->type = type;
+	this->gamma = model.gamma;
+	this->class_labels[0] = model.class_labels[0];
+	this->class_labels[1] = model.class_labels[1];
+	this->bias = -model.rho;
+
+	int d = model.var_count;
+	RNG rng(seed);
+
+	if (type == FEATURE_MAP_FOURIER) {
+
+		this->projection.create(dimension, d, CV_32FC1);
+		rng.fill(this->projection, RNG::NORMAL, Scalar(0), Scalar(sqrt(2.0*model.gamma)));
+
+		this->offset.create(1, dimension, CV_32FC1);
+		rng.fill(this->offset, RNG::UNIFORM, Scalar(0), Scalar(2.0*CV_PI));
+
+	} else if (type == FEATURE_MAP_NYSTROM) {
+
+		if (dimension >= model.sv_count) {
+			model.support_vectors.copyTo(this->projection);
+		} else {
+			landmark_centers(model.support_vectors, dimension, rng, this->projection);
+		}
+
+		this->offset.create(1, this->projection.rows, CV_32FC1);
+		for (int j = 0; j < this->projection.rows; j++) {
+			this->offset.at<float>(j) = (float) this->projection.row(j).dot(this->projection.row(j));
+		}
+
+	} else {
+		CV_Error(CV_StsBadArg, "Unknown feature map type");
+	}
+
+	// weights = sum_i alpha_i phi(sv_i). The Nystrom map is K_mm^-1/2 k_m(x);
+	// both square roots fold into the weights as the pseudo-inverse of K_mm,
+	// so transform() only computes k_m(x).
+	Mat mapped;
+	this->transform(model.support_vectors, mapped);
+
+	Mat alpha;
+	model.alpha.convertTo(alpha, CV_64F);
+	mapped.convertTo(mapped, CV_64F);
+
+	Mat w = alpha*mapped;
+
+	if (type == FEATURE_MAP_NYSTROM) {
+		Mat landmarks, kmm;
+		this->transform(this->projection, landmarks);
+		landmarks.convertTo(kmm, CV_64F);
+
+		Mat values, vectors;
+		eigen(kmm, values, vectors);
+
+		// drop the directions the landmarks do not really span
+		double largest = values.at<double>(0);
+		Mat inverse = Mat::zeros(kmm.size(), CV_64F);
+		for (int k = 0; k < values.rows; k++) {
+			double v = values.at<double>(k);
+			if (v > 1e-8*largest)
+				inverse += vectors.row(k).t()*vectors.row(k)/v;
+		}
+
+		w = w*inverse;
+	}
+
+	w.convertTo(this->weights, CV_32F);
+}
+
+void FeatureMap::load(string filename) {
+
+	FileStorage fs(filename, FileStorage::READ);
+	if (!fs.isOpened())
+		CV_Error(CV_StsError, "Could not open the feature map " + filename);
+
+	FileNode node = fs["feature_map"];
+
+	string type = (string) node["type"];
+	if (type == "FOURIER")
+		this->type = FEATURE_MAP_FOURIER;
+	else if (type == "NYSTROM")
+		this->type = FEATURE_MAP_NYSTROM;
+	else
+		CV_Error(CV_StsBadArg, "Unknown feature map type " + type);
+
+	this->gamma = (double) node["gamma"];
+	this->bias = (double) node["bias"];
+
+	Mat labels;
+	node["class_labels"] >> labels;
+	this->class_labels[0] = labels.at<int>(0);
+	this->class_labels[1] = labels.at<int>(1);
+
+	node["projection"] >> this->projection;
+	node["offset"] >> this->offset;
+	node["weights"] >> this->weights;
+
+	if (this->projection.rows != this->weights.cols || this->offset.cols != this->weights.cols)
+		CV_Error(CV_StsParseError, "Feature map sizes do not match");
+}
+
+void FeatureMap::save(string filename) const {
+
+	FileStorage fs(filename, FileStorage::WRITE);
+	if (!fs.isOpened())
+		CV_Error(CV_StsError, "Could not write the feature map " + filename);
+
+	fs << "feature_map" << "{";
+	fs << "type" << (this->type == FEATURE_MAP_FOURIER ? "FOURIER" : "NYSTROM");
+	fs << "gamma" << this->gamma;
+	fs << "bias" << this->bias;
+	fs << "class_labels" << (Mat_<int>(1, 2) << this->class_labels[0], this->class_labels[1]);
+	fs << "projection" << this->projection;
+	fs << "offset" << this->offset;
+	fs << "weights" << this->weights;
+	fs << "}";
+}
+
+void FeatureMap::transform(const Mat& samples, Mat& mapped) const {
+
+	CV_Assert(samples.type() == CV_32FC1 && samples.cols == this->projection.cols);
+
+	int n = samples.rows;
+	int D = this->projection.rows;
+
+	Mat offsets = repeat(this->offset, n, 1);
+
+	if (this->type == FEATURE_MAP_FOURIER) {
+
+		// sqrt(2/D) cos(W x + b)
+		gemm(samples, this->projection, 1.0, offsets, 1.0, mapped, GEMM_2_T);
+
+		float scale = (float) sqrt(2.0/D);
+		for (int i = 0; i < n; i++) {
+			float* z = mapped.ptr<float>(i);
+			for (int j = 0; j < D; j++) {
+				z[j] = scale*cos(z[j]);
+			}
+		}
+
+	} else {
+
+		// exp(-gamma (|x|^2 - 2 x.l + |l|^2))
+		gemm(samples, this->projection, -2.0, offsets, 1.0, mapped, GEMM_2_T);
+
+		for (int i = 0; i < n; i++) {
+			float norm = (float) samples.row(i).dot(samples.row(i));
+			float* z = mapped.ptr<float>(i);
+			for (int j = 0; j < D; j++) {
+				z[j] = (float)(-this->gamma*max(z[j] + norm, 0.0f));
+			}
+		}
+
+		exp(mapped, mapped);
+	}
+}
+
+void FeatureMap::decision(const Mat& samples, Mat& decisions) const {
+
+	Mat mapped;
+	this->transform(samples, mapped);
+
+	// one matrix-vector product for the whole batch
+	gemm(mapped, this->weights, 1.0, Mat(), 0.0, decisions, GEMM_2_T);
+	decisions += Scalar(this->bias);
+}
+
+void FeatureMap::predict(const Mat& samples, Mat& labels) const {
+
+	Mat decisions;
+	this->decision(samples, decisions);
+
+	labels.create(samples.rows, 1, CV_32FC1);
+	for (int i = 0; i < samples.rows; i++) {
+		labels.at<float>(i) = (float) this->class_labels[decisions.at<float>(i) > 0 ? 0 : 1];
+	}
+}
+
+double FeatureMap::agreement(const SvmModel& model, const Mat& samples) const {
+
+	if (samples.rows == 0)
+		return 1.0;
+
+	Mat labels;
+	this->predict(samples, labels);
+
+	int agree = 0;
+	for (int i = 0; i < samples.rows; i++) {
+		agree += (labels.at<float>(i) == model.predict(samples.ptr<float>(i)));
+	}
+
+	return (double)agree/samples.rows;
+}
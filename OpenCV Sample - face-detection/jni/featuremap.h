@@ -0,0 +1,80 @@
+/*
+ * featuremap.h
+ */
+
+#ifndef FEATUREMAP_H_
+#define FEATUREMAP_H_
+
+#include <opencv2/core/core.hpp>
+
+#include <string>
+
+#include "svmmodel.h"
+
+#define FEATURE_MAP_FOURIER 0	// random Fourier features, cos(W x + b)
+#define FEATURE_MAP_NYSTROM 1	// kernel values against k-means landmarks of the SVs
+
+using namespace cv;
+using namespace std;
+
+// Explicit approximation of an RBF SvmModel by a linear model on a
+// low-dimensional feature map phi:
+//
+//   decision(x) ~ bias + weights . phi(x)
+//
+// FEATURE_MAP_FOURIER draws W ~ N(0, 2 gamma) and b ~ U[0, 2 pi), so that
+// phi(x).phi(y) approximates K(x, y). FEATURE_MAP_NYSTROM takes landmarks
+// from the support vectors and projects onto the span of their kernel
+// functions; folded with the weights it reduces to a smaller SVM over the
+// landmarks. In both cases the weights are the alphas carried through the
+// map, sum_i alpha_i phi(sv_i), so no retraining is needed.
+//
+// Windows go in as rows of one matrix, so a frame's windows cost one
+// matrix product, one element-wise nonlinearity and one dot product each.
+class FeatureMap {
+
+public:
+	int type;
+	double gamma;
+	int class_labels[2];
+	Mat projection;		// D x d, Fourier frequencies or Nystrom landmarks
+	Mat offset;			// 1 x D, Fourier phases or landmark squared norms
+	Mat weights;		// 1 x D
+	double bias;
+
+public:
+	FeatureMap();
+
+	FeatureMap(string filename);
+
+	virtual ~FeatureMap();
+
+	void fit(const SvmModel& model, int type, int dimension, uint64 seed = 0x12345678);
+
+	void load(string filename);
+
+	void save(string filename) const;
+
+	bool empty() const {
+		return this->weights.empty();
+	}
+
+	int get_dimension() const {
+		return this->weights.cols;
+	}
+
+	int get_var_count() const {
+		return this->projection.cols;
+	}
+
+	void transform(const Mat& samples, Mat& mapped) const;
+
+	void decision(const Mat& samples, Mat& decisions) const;
+
+	void predict(const Mat& samples, Mat& labels) const;
+
+	double agreement(const SvmModel& model, const Mat& samples) const;
+
+};
+
+#endif /* FEATUREMAP_H_ */
@@ -0,0 +1,108 @@
+/*
+ * featureprojection.cpp
+ */
+
+#include "featureprojection.h"
+
+#include <opencv2/core/core_c.h>
+
+#include <cmath>
+
+FeatureProjection::FeatureProjection() {
+}
+
+FeatureProjection::~FeatureProjection() {
+}
+
+void FeatureProjection::normalization(const Mat& mean, const Mat& deviation) {
+
+	int d = mean.cols;
+
+	this->transform = Mat::zeros(d, d, CV_32FC1);
+	this->offset.create(1, d, CV_32FC1);
+
+	for (int k = 0; k < d; k++) {
+		float s = deviation.at<float>(k);
+		this->transform.at<float>(k, k) = 1.0f/s;
+		this->offset.at<float>(k) = -mean.at<float>(k)/s;
+	}
+}
+
+void FeatureProjection::fit(const Mat& features, const Mat& mean, const Mat& deviation,
+							int components, bool whiten) {
+
+	int d = features.cols;
+
+	Mat normalized(features.size(), CV_64FC1);
+	for (int i = 0; i < features.rows; i++) {
+		const float* x = features.ptr<float>(i);
+		double* z = normalized.ptr<double>(i);
+		for (int k = 0; k < d; k++) {
+			z[k] = (x[k] - mean.at<float>(k))/deviation.at<float>(k);
+		}
+	}
+
+	PCA pca(normalized, Mat(), CV_PCA_DATA_AS_ROW, components);
+
+	// A = W P diag(1/std), b = -W P (mean/std + mu)
+	Mat P = pca.eigenvectors.clone();
+	if (whiten) {
+		for (int c = 0; c < P.rows; c++) {
+			double v = pca.eigenvalues.at<double>(c);
+			P.row(c) *= v > 1e-12 ? 1.0/sqrt(v) : 0.0;
+		}
+	}
+
+	Mat A(P.size(), CV_64FC1);
+	Mat shift(d, 1, CV_64FC1);
+	for (int k = 0; k < d; k++) {
+		double s = deviation.at<float>(k);
+		A.col(k) = P.col(k)/s;
+		shift.at<double>(k) = mean.at<float>(k)/s + pca.mean.at<double>(k);
+	}
+
+	Mat b = -P*shift;
+
+	A.convertTo(this->transform, CV_32F);
+	Mat(b.t()).convertTo(this->offset, CV_32F);
+}
+
+void FeatureProjection::apply(const Mat& features, Mat& projected) const {
+
+	CV_Assert(features.type() == CV_32FC1 && features.cols == this->transform.cols);
+
+	gemm(features, this->transform, 1.0, repeat(this->offset, features.rows, 1), 1.0,
+		 projected, GEMM_2_T);
+}
+
+void FeatureProjection::apply(const float* x, float* y) const {
+
+	int d = this->transform.cols;
+	const float* b = this->offset.ptr<float>(0);
+
+	for (int c = 0; c < this->transform.rows; c++) {
+		const float* a = this->transform.ptr<float>(c);
+		float s = b[c];
+		for (int k = 0; k < d; k++) {
+			s += a[k]*x[k];
+		}
+		y[c] = s;
+	}
+}
+
+void FeatureProjection::read(const FileNode& node) {
+
+	node["transform"] >> this->transform;
+	node["offset"] >> this->offset;
+
+	if (this->transform.type() != CV_32FC1 || this->offset.cols != this->transform.rows)
+		CV_Error(CV_StsParseError, "Projection sizes do not match");
+}
+
+void FeatureProjection::write(FileStorage& fs, string name) const {
+
+	fs << name << "{";
+	fs << "transform" << this->transform;
+	fs << "offset" << this->offset;
+	fs << "}";
+}
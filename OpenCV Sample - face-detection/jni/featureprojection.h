@@ -0,0 +1,66 @@
+/*
+ * featureprojection.h
+ */
+
+#ifndef FEATUREPROJECTION_H_
+#define FEATUREPROJECTION_H_
+
+#include <opencv2/core/core.hpp>
+
+#include <string>
+
+using namespace cv;
+using namespace std;
+
+// Affine map y = A x + b from a raw window descriptor to the space the
+// classifier was trained in.
+//
+// Without PCA it is the usual (x - mean)/std. With PCA it goes on to
+// project onto the first principal components of the normalised training
+// features, optionally whitened to unit variance:
+//
+//   y = W P ((x - mean)/std - mu)
+//
+// Normalisation, centring, projection and whitening are all linear, so
+// they fold into one k x d matrix A and one offset b: a batch of windows
+// is a single gemm and there is no separate normalisation pass.
+class FeatureProjection {
+
+public:
+	Mat transform;	// k x d, CV_32FC1
+	Mat offset;		// 1 x k, CV_32FC1
+
+public:
+	FeatureProjection();
+
+	virtual ~FeatureProjection();
+
+	// (x - mean)/std only
+	void normalization(const Mat& mean, const Mat& deviation);
+
+	void fit(const Mat& features, const Mat& mean, const Mat& deviation,
+			 int components, bool whiten = false);
+
+	bool empty() const {
+		return this->transform.empty();
+	}
+
+	int get_input_dimension() const {
+		return this->transform.cols;
+	}
+
+	int get_output_dimension() const {
+		return this->transform.rows;
+	}
+
+	void apply(const Mat& features, Mat& projected) const;
+
+	void apply(const float* x, float* y) const;
+
+	void read(const FileNode& node);
+
+	void write(FileStorage& fs, string name) const;
+
+};
+
+#endif /* FEATUREPROJECTION_H_ */
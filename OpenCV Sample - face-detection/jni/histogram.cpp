@@ -2,13 +2,120 @@
 
 #include <vector>
 
+// Number of private sub-histograms used while counting. Consecutive pixels
+// go to different banks, so a run of identical codes (flat regions) does
+// not keep incrementing the same counter and stall on store-to-load forwarding.
+// accumulate_banks_ is unrolled for exactly this many banks.
+#define HISTOGRAM_BANKS 4
+
+// Below this many pixels the parallel variant just runs the serial kernel.
+#define HISTOGRAM_PARALLEL_MIN_PIXELS (1 << 16)
+
+// Banks are padded to a whole number of cache lines (16 ints) and start on
+// a cache line, see aligned_banks, so two banks never share one.
+#define HISTOGRAM_CACHE_LINE 64
+
+static inline int bank_stride(int numPatterns) {
+	return (numPatterns + 15) & ~15;
+}
+
+// AutoBuffer is only as aligned as the allocator; the buffer is allocated
+// one cache line larger and the banks start at the first aligned int.
+static inline int* aligned_banks(AutoBuffer<int>& buffer) {
+	return alignPtr((int*)buffer, HISTOGRAM_CACHE_LINE);
+}
+
+#define BANK_BUFFER_SIZE(stride) (HISTOGRAM_BANKS*(stride) + HISTOGRAM_CACHE_LINE/sizeof(int))
+
+template <typename _Tp>
+static void accumulate_banks_(const Mat& src, int rowStart, int rowEnd, int* banks, int stride) {
+	int* b0 = banks;
+	int* b1 = banks + stride;
+	int* b2 = banks + 2*stride;
+	int* b3 = banks + 3*stride;
+	for(int i = rowStart; i < rowEnd; i++) {
+		const _Tp* p = src.ptr<_Tp>(i);
+		int j = 0;
+		for(; j <= src.cols - HISTOGRAM_BANKS; j += HISTOGRAM_BANKS) {
+			b0[(int)p[j]]++;
+			b1[(int)p[j+1]]++;
+			b2[(int)p[j+2]]++;
+			b3[(int)p[j+3]]++;
+		}
+		for(; j < src.cols; j++) {
+			b0[(int)p[j]]++;
+		}
+	}
+}
+
+static void merge_banks(const int* banks, int stride, int* dst, int numPatterns) {
+	for(int k = 0; k < numPatterns; k++) {
+		int sum = 0;
+		for(int b = 0; b < HISTOGRAM_BANKS; b++) {
+			sum += banks[b*stride + k];
+		}
+		dst[k] += sum;
+	}
+}
+
 template <typename _Tp>
 void lbp::histogram_(const Mat& src, Mat& hist, int numPatterns) {
 	hist = Mat::zeros(1, numPatterns, CV_32SC1);
-	for(int i = 0; i < src.rows; i++) {
-		for(int j = 0; j < src.cols; j++) {
-			int bin = src.at<_Tp>(i,j);
-			hist.at<int>(0,bin) += 1;
+	int stride = bank_stride(numPatterns);
+	AutoBuffer<int> buffer(BANK_BUFFER_SIZE(stride));
+	int* banks = aligned_banks(buffer);
+	memset(banks, 0, HISTOGRAM_BANKS*stride*sizeof(int));
+	accumulate_banks_<_Tp>(src, 0, src.rows, banks, stride);
+	merge_banks(banks, stride, hist.ptr<int>(0), numPatterns);
+}
+
+// Each stripe counts a horizontal band of the image into its own banks and
+// writes the merged result into its own row of partial, so no locking is
+// needed; the rows are summed once all stripes are done.
+template <typename _Tp>
+class HistogramStripes : public ParallelLoopBody {
+public:
+	HistogramStripes(const Mat& src, Mat& partial, int numPatterns)
+		: src(src), partial(partial), numPatterns(numPatterns) {}
+
+	void operator()(const Range& range) const {
+		int stride = bank_stride(numPatterns);
+		int stripes = partial.rows;
+		AutoBuffer<int> buffer(BANK_BUFFER_SIZE(stride));
+		int* banks = aligned_banks(buffer);
+		for(int s = range.start; s < range.end; s++) {
+			int rowStart = (int)((int64)src.rows*s/stripes);
+			int rowEnd = (int)((int64)src.rows*(s+1)/stripes);
+			memset(banks, 0, HISTOGRAM_BANKS*stride*sizeof(int));
+			accumulate_banks_<_Tp>(src, rowStart, rowEnd, banks, stride);
+			merge_banks(banks, stride, partial.ptr<int>(s), numPatterns);
+		}
+	}
+
+private:
+	const Mat& src;
+	Mat& partial;
+	int numPatterns;
+};
+
+template <typename _Tp>
+void lbp::parallel_histogram_(const Mat& src, Mat& hist, int numPatterns) {
+	int stripes = min(src.rows, max(getNumThreads(), 1)*4);
+	if(src.total() < HISTOGRAM_PARALLEL_MIN_PIXELS || stripes < 2) {
+		histogram_<_Tp>(src, hist, numPatterns);
+		return;
+	}
+	Mat partial = Mat::zeros(stripes, numPatterns, CV_32SC1);
+	parallel_for_(Range(0, stripes), HistogramStripes<_Tp>(src, partial, numPatterns));
+
+	// cv::reduce has no CV_REDUCE_SUM for a CV_32S source, so the stripes'
+	// rows are summed here
+	hist = Mat::zeros(1, numPatterns, CV_32SC1);
+	int* dst = hist.ptr<int>(0);
+	for(int s = 0; s < stripes; s++) {
+		const int* row = partial.ptr<int>(s);
+		for(int k = 0; k < numPatterns; k++) {
+			dst[k] += row[k];
 		}
 	}
 }
@@ -31,25 +138,127 @@ double lbp::chi_square_(const Mat& histogram0, const Mat& histogram1) {
 }
 
 
-//void lbp::spatial_histogram(const Mat& src, Mat& hist, int numPatterns, const Size& window, int overlap) {
-//	int width = src.cols;
-//	int height = src.rows;
-//	vector<Mat> histograms;
-//	for(int x=0; x < width - window.width; x+=(window.width-overlap)) {
-//		for(int y=0; y < height-window.height; y+=(window.height-overlap)) {
-//			Mat cell = Mat(src, Rect(x,y,window.width, window.height));
-//			histograms.push_back(histogram(cell, numPatterns));
-//		}
-//	}
-//	hist.create(1, histograms.size()*numPatterns, CV_32SC1);
-//	// i know this is a bit lame now... feel free to make this a bit more efficient...
-//	for(int histIdx=0; histIdx < histograms.size(); histIdx++) {
-//		for(int valIdx = 0; valIdx < numPatterns; valIdx++) {
-//			int y = histIdx*numPatterns+valIdx;
-//			hist.at<int>(0,y) = histograms[histIdx].at<int>(valIdx);
-//		}
-//	}
-//}
+// Cells start every (window - overlap) pixels and span window pixels, so
+// every cell border falls on a multiple of gcd(step, window) along x.
+// Overlapping cells are built one cell row at a time from a strip: the
+// histograms of the gx wide column blocks of the cell row's window.height
+// rows. Moving down a cell row the strip drops the rows that leave and counts
+// the rows that enter, so each pixel is counted about twice however much the
+// cells overlap; a prefix sum over the strip's blocks then gives every cell
+// of the row with one subtraction. The strip takes one image row of blocks,
+// not the whole grid. When the cells are so small and sparse that counting
+// their pixels directly is cheaper, that is done instead. Without overlap the
+// pixels are counted straight into the descriptor row.
+static int greatest_common_divisor(int a, int b) {
+	while(b != 0) {
+		int t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+template <typename _Tp>
+static void count_strip_rows_(const Mat& src, int rowStart, int rowEnd, int width, int gx, int numPatterns,
+		int* counts, int delta) {
+	for(int i = rowStart; i < rowEnd; i++) {
+		const _Tp* p = src.ptr<_Tp>(i);
+		for(int j = 0; j < width; j++) {
+			counts[(j/gx)*numPatterns + (int)p[j]] += delta;
+		}
+	}
+}
+
+template <typename _Tp>
+void lbp::spatial_histogram_(const Mat& src, Mat& hist, int numPatterns, const Size& window, int overlap) {
+	if(window.width <= 0 || window.height <= 0)
+		CV_Error(CV_StsBadArg, "Window must not be empty.");
+	if(overlap < 0 || overlap >= window.width || overlap >= window.height)
+		CV_Error(CV_StsBadArg, "Overlap must be smaller than the window.");
+	if(window.width > src.cols || window.height > src.rows)
+		CV_Error(CV_StsBadArg, "Window must fit inside the image.");
+
+	int stepx = window.width - overlap;
+	int stepy = window.height - overlap;
+	int cellsx = (src.cols - window.width)/stepx + 1;
+	int cellsy = (src.rows - window.height)/stepy + 1;
+
+	int gx = greatest_common_divisor(stepx, window.width);
+	// blocks per step and per window
+	int sx = stepx/gx, kx = window.width/gx;
+	// pixels covered by the grid, and the blocks that cover a row of them
+	int width = (cellsx-1)*stepx + window.width;
+	int height = (cellsy-1)*stepy + window.height;
+	int blocks = width/gx;
+
+	hist = Mat::zeros(1, cellsx*cellsy*numPatterns, CV_32SC1);
+	int* dst = hist.ptr<int>(0);
+
+	if(overlap == 0) {
+		for(int i = 0; i < height; i++) {
+			const _Tp* p = src.ptr<_Tp>(i);
+			int* row = dst + (i/window.height)*cellsx*numPatterns;
+			for(int j = 0; j < width; j++) {
+				row[(j/window.width)*numPatterns + (int)p[j]]++;
+			}
+		}
+		return;
+	}
+
+	// pixel counts of the two ways, the strip's including its prefix sums
+	double direct = (double)cellsx*cellsy*window.width*window.height;
+	double strips = 2.0*width*height + (double)cellsy*(blocks + cellsx)*numPatterns;
+
+	if(direct <= strips) {
+		for(int cy = 0; cy < cellsy; cy++) {
+			for(int cx = 0; cx < cellsx; cx++) {
+				int* cell = dst + (cy*cellsx + cx)*numPatterns;
+				for(int i = cy*stepy; i < cy*stepy + window.height; i++) {
+					const _Tp* p = src.ptr<_Tp>(i) + cx*stepx;
+					for(int j = 0; j < window.width; j++) {
+						cell[(int)p[j]]++;
+					}
+				}
+			}
+		}
+		return;
+	}
+
+	Mat strip = Mat::zeros(1, blocks*numPatterns, CV_32SC1);
+	Mat prefix = Mat::zeros(1, (blocks+1)*numPatterns, CV_32SC1);
+	int* counts = strip.ptr<int>(0);
+	int* sums = prefix.ptr<int>(0);
+
+	for(int cy = 0; cy < cellsy; cy++) {
+		int top = cy*stepy;
+		if(cy == 0) {
+			count_strip_rows_<_Tp>(src, 0, window.height, width, gx, numPatterns, counts, 1);
+		} else {
+			count_strip_rows_<_Tp>(src, top - stepy, top, width, gx, numPatterns, counts, -1);
+			count_strip_rows_<_Tp>(src, top - stepy + window.height, top + window.height, width, gx, numPatterns, counts, 1);
+		}
+
+		// sums[j] holds blocks 0..j-1; sums[0] stays zero
+		for(int j = 0; j < blocks; j++) {
+			const int* block = counts + j*numPatterns;
+			const int* before = sums + j*numPatterns;
+			int* after = sums + (j+1)*numPatterns;
+			for(int b = 0; b < numPatterns; b++) {
+				after[b] = before[b] + block[b];
+			}
+		}
+
+		int* out = dst + cy*cellsx*numPatterns;
+		for(int cx = 0; cx < cellsx; cx++) {
+			const int* first = sums + cx*sx*numPatterns;
+			const int* last = sums + (cx*sx + kx)*numPatterns;
+			int* cell = out + cx*numPatterns;
+			for(int b = 0; b < numPatterns; b++) {
+				cell[b] = last[b] - first[b];
+			}
+		}
+	}
+}
 
 // wrappers
 void lbp::histogram(const Mat& src, Mat& hist, int numPatterns) {
@@ -62,6 +271,16 @@ void lbp::histogram(const Mat& src, Mat& hist, int numPatterns) {
 	}
 }
 
+void lbp::parallel_histogram(const Mat& src, Mat& hist, int numPatterns) {
+	switch(src.type()) {
+		case CV_8SC1: parallel_histogram_<char>(src, hist, numPatterns); break;
+		case CV_8UC1: parallel_histogram_<unsigned char>(src, hist, numPatterns); break;
+		case CV_16SC1: parallel_histogram_<short>(src, hist, numPatterns); break;
+		case CV_16UC1: parallel_histogram_<unsigned short>(src, hist, numPatterns); break;
+		case CV_32SC1: parallel_histogram_<int>(src, hist, numPatterns); break;
+	}
+}
+
 double lbp::chi_square(const Mat& histogram0, const Mat& histogram1) {
 	switch(histogram0.type()) {
 		case CV_8SC1: return chi_square_<char>(histogram0,histogram1); break;
@@ -72,11 +291,21 @@ double lbp::chi_square(const Mat& histogram0, const Mat& histogram1) {
 	}
 }
 
-//void lbp::spatial_histogram(const Mat& src, Mat& dst, int numPatterns, int gridx, int gridy, int overlap) {
-//	int width = static_cast<int>(floor(src.cols/gridx));
-//	int height = static_cast<int>(floor(src.rows / gridy));
-//	spatial_histogram(src, dst, numPatterns, Size_<int>(width, height), overlap);
-//}
+void lbp::spatial_histogram(const Mat& src, Mat& hist, int numPatterns, const Size& window, int overlap) {
+	switch(src.type()) {
+		case CV_8SC1: spatial_histogram_<char>(src, hist, numPatterns, window, overlap); break;
+		case CV_8UC1: spatial_histogram_<unsigned char>(src, hist, numPatterns, window, overlap); break;
+		case CV_16SC1: spatial_histogram_<short>(src, hist, numPatterns, window, overlap); break;
+		case CV_16UC1: spatial_histogram_<unsigned short>(src, hist, numPatterns, window, overlap); break;
+		case CV_32SC1: spatial_histogram_<int>(src, hist, numPatterns, window, overlap); break;
+	}
+}
+
+void lbp::spatial_histogram(const Mat& src, Mat& dst, int numPatterns, int gridx, int gridy, int overlap) {
+	int width = static_cast<int>(floor(src.cols/gridx));
+	int height = static_cast<int>(floor(src.rows / gridy));
+	spatial_histogram(src, dst, numPatterns, Size_<int>(width, height), overlap);
+}
 
 // Mat return type functions
 Mat lbp::histogram(const Mat& src, int numPatterns) {
@@ -85,16 +314,22 @@ Mat lbp::histogram(const Mat& src, int numPatterns) {
 	return hist;
 }
 
+Mat lbp::parallel_histogram(const Mat& src, int numPatterns) {
+	Mat hist;
+	parallel_histogram(src, hist, numPatterns);
+	return hist;
+}
 
-//Mat lbp::spatial_histogram(const Mat& src, int numPatterns, const Size& window, int overlap) {
-//	Mat hist;
-//	spatial_histogram(src, hist, numPatterns, window, overlap);
-//	return hist;
-//}
-//
-//
-//Mat lbp::spatial_histogram(const Mat& src, int numPatterns, int gridx, int gridy, int overlap) {
-//	Mat hist;
-//	spatial_histogram(src, hist, numPatterns, gridx, gridy);
-//	return hist;
-//}
+
+Mat lbp::spatial_histogram(const Mat& src, int numPatterns, const Size& window, int overlap) {
+	Mat hist;
+	spatial_histogram(src, hist, numPatterns, window, overlap);
+	return hist;
+}
+
+
+Mat lbp::spatial_histogram(const Mat& src, int numPatterns, int gridx, int gridy, int overlap) {
+	Mat hist;
+	spatial_histogram(src, hist, numPatterns, gridx, gridy, overlap);
+	return hist;
+}
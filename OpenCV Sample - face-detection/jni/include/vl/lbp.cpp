@@ -141,3 +141,45 @@ void vl_lbp_process (VlLbp * self,
     }
   }
 }
+
+/* ---------------------------------------------------------------- */
+
+/* Writes the uniform bin of every pixel of an 8-bit image, with the same
+   neighbourhood order and mapping as vl_lbp_process. Border pixels have
+   no full neighbourhood and get the bin vl_lbp_get_dimension(self). */
+
+void vl_lbp_process_bins (VlLbp * self,
+                vl_uint8 * bins,
+                vl_uint8 const * image, vl_size width, vl_size height,
+                vl_size stride) {
+  vl_index x,y ;
+  vl_uint8 border = (vl_uint8) vl_lbp_get_dimension(self) ;
+
+#define pix(u,v) (*(image + stride * (v) + (u)))
+#define bin(u,v) (*(bins + width * (v) + (u)))
+
+  for (y = 0 ; y < (signed)height ; ++y) {
+    for (x = 0 ; x < (signed)width ; ++x) {
+      if (x == 0 || y == 0 || x == (signed)width - 1 || y == (signed)height - 1) {
+        bin(x,y) = border ;
+        continue ;
+      }
+      {
+        int unsigned bitString = 0 ;
+        vl_uint8 center = pix(x,y) ;
+        if(pix(x+1,y+0) > center) bitString |= 0x1 << 0; /*  E */
+        if(pix(x+1,y+1) > center) bitString |= 0x1 << 1; /* SE */
+        if(pix(x+0,y+1) > center) bitString |= 0x1 << 2; /* S  */
+        if(pix(x-1,y+1) > center) bitString |= 0x1 << 3; /* SW */
+        if(pix(x-1,y+0) > center) bitString |= 0x1 << 4; /*  W */
+        if(pix(x-1,y-1) > center) bitString |= 0x1 << 5; /* NW */
+        if(pix(x+0,y-1) > center) bitString |= 0x1 << 6; /* N  */
+        if(pix(x+1,y-1) > center) bitString |= 0x1 << 7; /* NE */
+        bin(x,y) = self->mapping[bitString] ;
+      }
+    }
+  }
+
+#undef pix
+#undef bin
+}
@@ -19,6 +19,10 @@ void vl_lbp_process(VlLbp * self,
                             float * features,
                             float * image, vl_size width, vl_size height,
                             vl_size cellSize) ;
+void vl_lbp_process_bins(VlLbp * self,
+                         vl_uint8 * bins,
+                         vl_uint8 const * image, vl_size width, vl_size height,
+                         vl_size stride) ;
 vl_size vl_lbp_get_dimension(VlLbp * self) ;
 
 #endif
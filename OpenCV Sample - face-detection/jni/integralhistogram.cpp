@@ -0,0 +1,134 @@
+/*
+ * integralhistogram.cpp
+ */
+
+#include "integralhistogram.h"
+
+#include <cmath>
+
+IntegralHistogram::IntegralHistogram() {
+
+	this->width = 0;
+	this->height = 0;
+	this->capacity = 0;
+	this->computed = 0;
+	this->m_lbp_model = vl_lbp_new(VlLbpUniform, false);
+
+}
+
+IntegralHistogram::~IntegralHistogram() {
+	vl_lbp_delete(this->m_lbp_model);
+}
+
+void IntegralHistogram::build(const Mat& image) {
+
+	CV_Assert(image.type() == CV_8UC1);
+
+	// the band keeps its rows while the width does not change
+	if (image.cols != this->width)
+		this->capacity = 0;
+
+	this->width = image.cols;
+	this->height = image.rows;
+	this->computed = 0;
+
+	this->bins.create(image.size(), CV_8UC1);
+	vl_lbp_process_bins(this->m_lbp_model, this->bins.ptr<vl_uint8>(0),
+						image.ptr<vl_uint8>(0), image.cols, image.rows, image.step);
+}
+
+void IntegralHistogram::cover(int top, int bottom) {
+
+	CV_Assert(0 <= top && top <= bottom && bottom <= this->height);
+
+	// capacity rows of width+1 positions of LBP_BINS counts each, row r of
+	// the integral in slot r % capacity
+	int rows = bottom - top + 1;
+	if (rows > this->capacity) {
+		this->capacity = rows;
+		this->integral.create(this->capacity, (this->width + 1)*LBP_BINS, CV_16UC1);
+		this->computed = 0;
+	}
+
+	// rows above the band are gone, start again from the top
+	if (top < this->computed - this->capacity)
+		this->computed = 0;
+
+	while (this->computed <= bottom) {
+		this->__compute_row(this->computed);
+		this->computed++;
+	}
+}
+
+void IntegralHistogram::__compute_row(int row) {
+
+	unsigned short* current = this->integral.ptr<unsigned short>(row % this->capacity);
+
+	// row and column 0 stay zero
+	if (row == 0) {
+		memset(current, 0, this->integral.cols*sizeof(unsigned short));
+		return;
+	}
+
+	const uchar* b = this->bins.ptr<uchar>(row - 1);
+	const unsigned short* above = this->__row(row - 1);
+
+	unsigned short running[LBP_BINS];
+	memset(running, 0, sizeof(running));
+	memset(current, 0, LBP_BINS*sizeof(unsigned short));
+
+	for (int x = 0; x < this->width; x++) {
+		if (b[x] < LBP_BINS)
+			running[b[x]]++;
+
+		const unsigned short* up = above + (x + 1)*LBP_BINS;
+		unsigned short* out = current + (x + 1)*LBP_BINS;
+		for (int k = 0; k < LBP_BINS; k++) {
+			out[k] = (unsigned short)(up[k] + running[k]);
+		}
+	}
+}
+
+void IntegralHistogram::histogram(int x, int y, int w, int h, unsigned short* hist) const {
+
+	CV_DbgAssert(x >= 0 && y >= 0 && x + w <= this->width && y + h <= this->height);
+	CV_DbgAssert(w*h <= INTEGRAL_MAX_AREA);
+
+	const unsigned short* top = this->__row(y);
+	const unsigned short* bottom = this->__row(y + h);
+	const unsigned short* a = top + x*LBP_BINS;
+	const unsigned short* b = top + (x + w)*LBP_BINS;
+	const unsigned short* c = bottom + x*LBP_BINS;
+	const unsigned short* d = bottom + (x + w)*LBP_BINS;
+
+	for (int k = 0; k < LBP_BINS; k++) {
+		hist[k] = (unsigned short)(d[k] - b[k] - c[k] + a[k]);
+	}
+}
+
+void IntegralHistogram::cell_features(int x, int y, int box_size, int cellsize, float* features) const {
+
+	int cwidth = box_size/cellsize;
+	int cstride = cwidth*cwidth;
+	unsigned short hist[LBP_BINS];
+
+	for (int cy = 0; cy < cwidth; cy++) {
+		for (int cx = 0; cx < cwidth; cx++) {
+			this->histogram(x + cx*cellsize, y + cy*cellsize, cellsize, cellsize, hist);
+			normalize_cell_histogram(hist, features + cy*cwidth + cx, cstride);
+		}
+	}
+}
+
+void normalize_cell_histogram(const unsigned short* hist, float* features, int cstride) {
+
+	float norm = 0;
+	for (int k = 0; k < LBP_BINS; k++) {
+		norm += hist[k];
+	}
+	norm = sqrtf(norm) + 1e-10f;
+
+	for (int k = 0; k < LBP_BINS; k++) {
+		features[k*cstride] = sqrtf((float)hist[k])/norm;
+	}
+}
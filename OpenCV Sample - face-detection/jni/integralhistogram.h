@@ -0,0 +1,96 @@
+/*
+ * integralhistogram.h
+ */
+
+#ifndef INTEGRALHISTOGRAM_H_
+#define INTEGRALHISTOGRAM_H_
+
+#include <opencv2/core/core.hpp>
+
+#include "include/vl/lbp.hpp"
+
+// uniform LBP bins counted by the integral histogram
+#define LBP_BINS 58
+
+// The largest rectangle whose counts are exact: the integrals are kept as
+// 16-bit values that wrap around, and the four-corner difference is exact
+// modulo 2^16 as long as the rectangle holds fewer than 65536 pixels.
+#define INTEGRAL_MAX_AREA 65535
+
+using namespace cv;
+
+// Integral histogram of the uniform LBP bins of one grayscale image (one
+// pyramid level). The LBP codes are computed once per image; afterwards the
+// 58-bin histogram of any rectangle takes four runs of 58 lookups, whatever
+// its position or size, so a scanner can use any stride, box size and cell
+// layout without recomputing LBP codes.
+//
+// Only a band of integral rows is kept, in a ring: a full table would be
+// (height+1) x (width+1) x 58 counts, about 36 MB at 640x480, for every
+// pyramid level of every frame. cover() extends the band downwards as the
+// scanner moves down the image, each row being computed once, and the band
+// is only as high as the tallest rectangle asked for (box_size + 1 rows,
+// 4.8 MB for a 64 pixel box at 640 pixels). Windows must therefore be
+// visited top to bottom; going back up recomputes the rows from the top.
+//
+// Counts are hard-binned: each pixel belongs to exactly one cell, unlike
+// the bilinear cell weights of vl_lbp_process. Models trained on
+// vl_lbp_process descriptors see a shifted feature distribution, so this
+// mode needs models retrained on its own descriptors.
+class IntegralHistogram {
+
+private:
+	int width;
+	int height;
+	Mat bins;
+	Mat integral;
+	int capacity;
+	int computed;
+	VlLbp* m_lbp_model;
+
+public:
+	IntegralHistogram();
+
+	virtual ~IntegralHistogram();
+
+	// Computes the LBP codes of image and empties the band.
+	void build(const Mat& image);
+
+	// Makes integral rows top to bottom available (row r sums image rows
+	// 0..r-1), so rectangles between those image rows can be read.
+	void cover(int top, int bottom);
+
+	// The counts of a rectangle inside the covered rows. Integrals are 16-bit
+	// and wrap around; the four-corner difference is exact only for
+	// rectangles of at most INTEGRAL_MAX_AREA pixels, true of any window.
+	void histogram(int x, int y, int w, int h, unsigned short* hist) const;
+
+	void cell_features(int x, int y, int box_size, int cellsize, float* features) const;
+
+	int get_width() const {
+		return this->width;
+	}
+
+	int get_height() const {
+		return this->height;
+	}
+
+	const Mat& get_bins() const {
+		return this->bins;
+	}
+
+private:
+
+	void __compute_row(int row);
+
+	const unsigned short* __row(int row) const {
+		CV_DbgAssert(row < this->computed && row >= this->computed - this->capacity);
+		return this->integral.ptr<unsigned short>(row % this->capacity);
+	}
+
+};
+
+// sqrt(h)/sqrt(sum h) per cell, the normalisation of vl_lbp_process
+void normalize_cell_histogram(const unsigned short* hist, float* features, int cstride);
+
+#endif /* INTEGRALHISTOGRAM_H_ */
@@ -0,0 +1,165 @@
+/*
+ * intersectionsvm.cpp
+ */
+
+#include "intersectionsvm.h"
+
+#include <cmath>
+
+IntersectionSvm::IntersectionSvm() {
+
+	this->bins = INTERSECTION_BINS;
+	this->bias = 0.0f;
+
+}
+
+IntersectionSvm::IntersectionSvm(string filename) {
+
+	this->bins = INTERSECTION_BINS;
+	this->bias = 0.0f;
+
+	this->load(filename);
+
+}
+
+IntersectionSvm::~IntersectionSvm() {
+}
+
+void IntersectionSvm::load(string filename) {
+
+	FileStorage fs(filename, FileStorage::READ);
+	if (!fs.isOpened())
+		CV_Error(CV_StsError, "Could not open the intersection model " + filename);
+
+	this->read(fs["intersection_svm"]);
+}
+
+void IntersectionSvm::load(const char* data, size_t length) {
+
+	FileStorage fs(string(data, length), FileStorage::READ + FileStorage::MEMORY);
+	if (!fs.isOpened())
+		CV_Error(CV_StsError, "Could not parse the intersection model");
+
+	this->read(fs["intersection_svm"]);
+}
+
+void IntersectionSvm::read(const FileNode& node) {
+
+	this->bins = (int) node["bins"];
+	this->bias = (float) node["bias"];
+	node["range"] >> this->range;
+	node["table"] >> this->table;
+
+	if (this->table.type() != CV_32FC1 || this->table.cols != this->bins + 1 ||
+			this->range.cols != this->table.rows)
+		CV_Error(CV_StsParseError, "Intersection model sizes do not match");
+
+	this->__set_scale();
+}
+
+void IntersectionSvm::save(string filename) const {
+
+	FileStorage fs(filename, FileStorage::WRITE);
+	if (!fs.isOpened())
+		CV_Error(CV_StsError, "Could not write the intersection model " + filename);
+
+	this->write(fs, "intersection_svm");
+}
+
+void IntersectionSvm::write(FileStorage& fs, string name) const {
+
+	fs << name << "{";
+	fs << "bins" << this->bins;
+	fs << "bias" << this->bias;
+	fs << "range" << this->range;
+	fs << "table" << this->table;
+	fs << "}";
+}
+
+void IntersectionSvm::__set_scale() {
+
+	this->scale.create(1, this->range.cols, CV_32FC1);
+	for (int d = 0; d < this->range.cols; d++) {
+		float r = this->range.at<float>(d);
+		this->scale.at<float>(d) = r > 0 ? this->bins/r : 0.0f;
+	}
+}
+
+void IntersectionSvm::encode(const Mat& features, Mat& encoded) const {
+
+	int n = features.rows;
+	int dims = features.cols;
+
+	encoded.create(n, dims*this->bins, CV_32FC1);
+
+	for (int i = 0; i < n; i++) {
+		const float* x = features.ptr<float>(i);
+		float* e = encoded.ptr<float>(i);
+
+		for (int d = 0; d < dims; d++) {
+			float delta = this->range.at<float>(d)/this->bins;
+			float root = sqrt(delta);
+			float t = x[d]*this->scale.at<float>(d);
+
+			for (int k = 0; k < this->bins; k++) {
+				e[d*this->bins + k] = root*min(max(t - k, 0.0f), 1.0f);
+			}
+		}
+	}
+}
+
+void IntersectionSvm::train(const Mat& features, const Mat& labels, int bins, double C) {
+
+	this->bins = bins;
+
+	int dims = features.cols;
+
+	this->range.create(1, dims, CV_32FC1);
+	for (int d = 0; d < dims; d++) {
+		double lo, hi;
+		minMaxLoc(features.col(d), &lo, &hi);
+		this->range.at<float>(d) = (float) max(hi, 1e-6);
+	}
+	this->__set_scale();
+
+	Mat encoded;
+	this->encode(features, encoded);
+
+	LinearSvm svm;
+	svm.fit(encoded, labels, C);
+
+	// at knot j every ramp below it is full, sqrt(delta), and every ramp
+	// above it is empty
+	const float* w = svm.weights.ptr<float>(0);
+	this->table.create(dims, bins + 1, CV_32FC1);
+	for (int d = 0; d < dims; d++) {
+		float root = sqrt(this->range.at<float>(d)/bins);
+		float* f = this->table.ptr<float>(d);
+
+		f[0] = 0.0f;
+		for (int j = 1; j <= bins; j++) {
+			f[j] = f[j - 1] + root*w[d*bins + j - 1];
+		}
+	}
+
+	this->bias = svm.bias;
+}
+
+float IntersectionSvm::score(const float* x) const {
+
+	const float* scale = this->scale.ptr<float>(0);
+	float s = this->bias;
+	int last = this->bins - 1;
+
+	for (int d = 0; d < this->table.rows; d++) {
+		const float* f = this->table.ptr<float>(d);
+
+		float t = max(x[d]*scale[d], 0.0f);
+		int k = min((int) t, last);
+		float frac = min(t - k, 1.0f);
+
+		s += f[k] + frac*(f[k + 1] - f[k]);
+	}
+
+	return s;
+}
@@ -0,0 +1,86 @@
+/*
+ * intersectionsvm.h
+ */
+
+#ifndef INTERSECTIONSVM_H_
+#define INTERSECTIONSVM_H_
+
+#include <opencv2/core/core.hpp>
+
+#include <string>
+
+#include "linearsvm.h"
+
+// knots per dimension of the piecewise-linear decision function
+#define INTERSECTION_BINS 16
+
+using namespace cv;
+using namespace std;
+
+// Additive SVM for the raw vl_lbp_process descriptors (non-negative,
+// sqrt-normalised histograms, no mean/std). The decision function is a sum
+// of one piecewise-linear function per dimension, kept as a lookup table
+// over bins + 1 evenly spaced knots in [0, range_d]:
+//
+//   score(x) = bias + sum_d lerp(table_d, x_d/range_d*bins)
+//
+// so a window costs var_count lookups whatever the size of the training
+// set, and faces score above zero.
+//
+// Training follows Maji and Berg: every value is encoded by bins ramps of
+// width delta, sqrt(delta) clamp((x - t_k)/delta, 0, 1), whose dot product
+// approximates the intersection kernel min(x, y). A linear SVM on the
+// encoding then is an intersection-kernel SVM, and each table entry is
+// the running sum of its weights at one knot.
+class IntersectionSvm {
+
+public:
+	int bins;
+	Mat range;		// 1 x d, values above range_d read the last knot
+	Mat table;		// d x (bins + 1)
+	float bias;
+
+private:
+	Mat scale;		// bins/range_d
+
+public:
+	IntersectionSvm();
+
+	IntersectionSvm(string filename);
+
+	virtual ~IntersectionSvm();
+
+	void load(string filename);
+
+	void load(const char* data, size_t length);
+
+	void save(string filename) const;
+
+	void read(const FileNode& node);
+
+	void write(FileStorage& fs, string name) const;
+
+	bool empty() const {
+		return this->table.empty();
+	}
+
+	int get_var_count() const {
+		return this->table.rows;
+	}
+
+	void train(const Mat& features, const Mat& labels, int bins = INTERSECTION_BINS, double C = 1.0);
+
+	void encode(const Mat& features, Mat& encoded) const;
+
+	float score(const float* x) const;
+
+	float predict(const float* x) const {
+		return this->score(x) > 0 ? 1.0f : -1.0f;
+	}
+
+private:
+	void __set_scale();
+
+};
+
+#endif /* INTERSECTIONSVM_H_ */
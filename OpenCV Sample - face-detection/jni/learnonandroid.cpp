@@ -7,6 +7,11 @@
 
 #include "learnonandroid.h"
 
+#include <android/log.h>
+
+#define LOG_TAG "FaceDetection/LearnOnAndroid"
+#define LOGD(...) ((void)__android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__))
+
 LearnOnAndroid::LearnOnAndroid() {
 
 	this->set_lbp_model();
@@ -16,8 +21,12 @@ LearnOnAndroid::LearnOnAndroid() {
 	this->dimension_buffer = 0;
 	this->feature_vector = NULL;
 	this->default_cellsize = DEFAULT_CELLSIZE;
+	this->descriptor_mode = DESCRIPTOR_VLFEAT;
+	this->embedded = false;
+	this->score_threshold = 0.0;
 	this->has_setted_feature_vector = false;
 
+	this->__init_prefilter();
 	this->set_dimension_histogram();
 
 }
@@ -26,14 +35,20 @@ LearnOnAndroid::LearnOnAndroid(Mat input_image, string model) {
 
 	this->set_lbp_model();
 	this->set_image(input_image);
-	this->set_classification_model(model);
+	// an empty path leaves the scan to a bundle or the embedded model
+	if (!model.empty())
+		this->set_classification_model(model);
 
 	this->has_setted_feature_vector = false;
 
 	this->stride = STRIDE;
 	this->box_size = BOX_SIZE;
 	this->default_cellsize = DEFAULT_CELLSIZE;
+	this->descriptor_mode = DESCRIPTOR_VLFEAT;
+	this->embedded = false;
+	this->score_threshold = 0.0;
 
+	this->__init_prefilter();
 	this->set_dimension_histogram();
 	this->set_dimension_buffer();
 
@@ -60,7 +75,93 @@ void LearnOnAndroid::load_image(string image_filename) {
 }
 
 void LearnOnAndroid::set_classification_model(string model) {
-	this->SVM.load(model.c_str());
+	this->svm_model.load(model);
+}
+
+void LearnOnAndroid::set_early_exit_model(string model, int clusters) {
+	this->early_exit.set_model(SvmModel(model), clusters);
+}
+
+void LearnOnAndroid::set_quantized_model(string model, string mean, string deviation) {
+
+	Mat m, d;
+	load_text_vector(mean, m);
+	load_text_vector(deviation, d);
+
+	this->quantized.quantize(SvmModel(model), m, d);
+}
+
+void LearnOnAndroid::set_embedded_model(bool embedded) {
+
+#ifndef EMBEDDED_MODEL
+	if (embedded)
+		CV_Error(CV_StsError, "Built without EMBEDDED_MODEL, see tools/embed_model.cpp");
+#endif
+
+	this->embedded = embedded;
+}
+
+void LearnOnAndroid::use_models(const DetectorModels& models) {
+
+	this->svm_model = models.svm;
+	this->early_exit = models.early_exit;
+	this->prefilter = models.prefilter;
+	this->intersection = models.intersection;
+	this->cascade = models.cascade;
+	this->feature_map = models.feature_map;
+	this->bundle = models.bundle;
+
+	if (models.mean.cols == this->dimension_histogram && models.deviation.cols == this->dimension_histogram) {
+		this->vector_mean = models.mean;
+		this->vector_std = models.deviation;
+	} else if (this->vector_mean.cols != this->dimension_histogram) {
+		this->vector_mean.release();
+		this->vector_std.release();
+	}
+}
+
+void LearnOnAndroid::set_scan_parameters(const ScanParameters& parameters) {
+
+	this->stride = parameters.stride;
+	this->box_size = parameters.box_size;
+	this->default_cellsize = parameters.cell_size;
+	this->score_threshold = parameters.score_threshold;
+	this->descriptor_mode = parameters.descriptor_mode;
+
+	this->set_dimension_histogram();
+}
+
+void LearnOnAndroid::__init_prefilter() {
+	this->prefilter_audit = false;
+	this->reset_prefilter_statistics();
+}
+
+void LearnOnAndroid::set_prefilter_model(string model) {
+	this->prefilter.load(model, this->dimension_histogram);
+}
+
+void LearnOnAndroid::reset_prefilter_statistics() {
+	this->prefilter_statistics.scanned = 0;
+	this->prefilter_statistics.rejected = 0;
+	this->prefilter_statistics.positives = 0;
+	this->prefilter_statistics.missed = 0;
+}
+
+void LearnOnAndroid::report_prefilter_statistics() {
+
+	if (this->prefilter.empty() || this->prefilter_statistics.scanned == 0)
+		return;
+
+	// logcat, cout goes nowhere on the device
+	LOGD("prefilter: rejected %d of %d windows (%.1f%%)", this->prefilter_statistics.rejected,
+		 this->prefilter_statistics.scanned, 100.0*this->prefilter_statistics.rejected/this->prefilter_statistics.scanned);
+
+	// only known when the RBF model also ran on the rejected windows, see
+	// DetectionBasedTracker.setPrefilterAudit
+	if (this->prefilter_audit && this->prefilter_statistics.positives > 0) {
+		LOGD("prefilter: recall loss %d of %d RBF detections (%.2f%%)", this->prefilter_statistics.missed,
+			 this->prefilter_statistics.positives, 100.0*this->prefilter_statistics.missed/this->prefilter_statistics.positives);
+	}
 }
 
 void LearnOnAndroid::set_dimension_buffer() {
@@ -119,6 +220,12 @@ void LearnOnAndroid::__set_feature_vector(int dimension) {
 
 }
 
+void LearnOnAndroid::__reserve_feature_vector() {
+
+	if (this->dimension_buffer < this->dimension_histogram)
+		this->set_feature_vector(this->dimension_histogram);
+}
+
 void LearnOnAndroid::set_feature_vector(int dimension) {
 
 	if (this->has_setted_feature_vector) {
@@ -164,23 +271,22 @@ void LearnOnAndroid::__delete_input_image() {
 
 void LearnOnAndroid::__normalize_feature_vector() {
 
-	float* vector_mean;
-	float* vector_std;
-
-	vector_mean = new float[this->dimension_histogram];
-	vector_std  = new float[this->dimension_histogram];
+	// loaded once, not on every window
+	if (this->vector_mean.empty()) {
+		this->vector_mean.create(1, this->dimension_histogram, CV_32FC1);
+		this->vector_std.create(1, this->dimension_histogram, CV_32FC1);
+		this->__load_vector("/storage/sdcard0/mean.txt", this->vector_mean.ptr<float>(0));
+		this->__load_vector("/storage/sdcard0/std.txt", this->vector_std.ptr<float>(0));
+	}
 
-	this->__load_vector("/storage/sdcard0/mean.txt", vector_mean);
-	this->__load_vector("/storage/sdcard0/std.txt", vector_std);
+	const float* vector_mean = this->vector_mean.ptr<float>(0);
+	const float* vector_std = this->vector_std.ptr<float>(0);
 
 	for (int i = 0; i < this->dimension_histogram; i++) {
 		this->feature_vector[i] -= vector_mean[i];
 		this->feature_vector[i] /= vector_std[i];
 	}
 
-	delete[] vector_mean;
-	delete[] vector_std;
-
 }
 
 void LearnOnAndroid::__load_vector(string filename, float* vector) {
@@ -205,58 +311,178 @@ void LearnOnAndroid::set_dimension_histogram() {
 								   (this->box_size/this->get_default_cellsize());
 }
 
-float LearnOnAndroid::__testing() {
+void LearnOnAndroid::__extract_window_features(int row, int col) {
+
+	if (this->descriptor_mode == DESCRIPTOR_INTEGRAL) {
+
+		this->integral_histogram.cover(row, row + this->box_size);
+		this->integral_histogram.cell_features(col, row, this->box_size,
+											   this->default_cellsize, this->feature_vector);
+
+	} else if (this->descriptor_mode == DESCRIPTOR_SLIDING) {
+
+		this->sliding_histogram.move_to(col, row);
+		this->sliding_histogram.cell_features(this->feature_vector);
+
+	} else {
+
+		Mat image_roi = this->input_image(Range(row, row+this->box_size),
+										  Range(col, col+this->box_size));
+
+		this->extract_lbp_features(image_roi);
+
+	}
+}
+
+void LearnOnAndroid::__gather_window_features(const vector<Point>& corners, bool normalize) {
+
+	// one descriptor per row
+	this->window_features.create((int) corners.size(), this->dimension_histogram, CV_32FC1);
+	for (size_t w = 0; w < corners.size(); w++) {
+		this->__extract_window_features(corners[w].y, corners[w].x);
+		if (normalize)
+			this->__normalize_feature_vector();
+		memcpy(this->window_features.ptr<float>((int) w), this->feature_vector,
+			   this->dimension_histogram*sizeof(float));
+	}
+}
+
+void LearnOnAndroid::__classify_windows(const vector<Point>& corners, vector<float>& responses) {
+
+	responses.resize(corners.size());
+
+	// the backend is picked once per frame, every window of the frame then
+	// goes through the same instantiation of __score_windows
+#ifdef EMBEDDED_MODEL
+	if (this->embedded && this->cascade.empty()) {
+		EmbeddedRbfModel classifier;
+		this->__score_windows(classifier, corners, responses);
+		return;
+	}
+#endif
+
+	if (!this->cascade.empty()) {
+		CascadePolicy classifier(this->cascade, this->input_image, corners, this->box_size);
+		this->__score_windows(classifier, corners, responses);
+		return;
+	}
+
+	if (!this->bundle.empty()) {
+		switch (this->bundle.type) {
+		case BUNDLE_RBF: {
+			RbfPolicy classifier(this->bundle);
+			this->__score_windows(classifier, corners, responses);
+			break;
+		}
+		case BUNDLE_LINEAR: {
+			LinearPolicy classifier(this->bundle);
+			this->__score_windows(classifier, corners, responses);
+			break;
+		}
+		case BUNDLE_INTERSECTION: {
+			IntersectionPolicy classifier(this->bundle.intersection);
+			this->__score_windows(classifier, corners, responses);
+			break;
+		}
+		case BUNDLE_QUANTIZED: {
+			QuantizedPolicy classifier(this->bundle.quantized);
+			this->__score_windows(classifier, corners, responses);
+			break;
+		}
+		}
+		return;
+	}
+
+	if (!this->feature_map.empty()) {
+		FeatureMapPolicy classifier(this->feature_map);
+		this->__score_windows(classifier, corners, responses);
+		return;
+	}
+
+	if (!this->intersection.empty()) {
+		IntersectionPolicy classifier(this->intersection);
+		this->__score_windows(classifier, corners, responses);
+		return;
+	}
 
-	Mat testing = Mat(1, this->dimension_histogram, CV_32FC1);
+	if (!this->quantized.empty()) {
+		QuantizedPolicy classifier(this->quantized);
+		this->__score_windows(classifier, corners, responses);
+		return;
+	}
 
-	for (int i=0; i<this->dimension_histogram;i++){
-		testing.at<float>(i) = this->feature_vector[i];
+	if (!this->early_exit.empty()) {
+		EarlyExitPolicy classifier(this->early_exit, this->score_threshold);
+		this->__score_prefiltered(classifier, corners, responses);
+		return;
 	}
 
-	return this->SVM.predict(testing);
+	SvmPolicy classifier(this->svm_model);
+	this->__score_prefiltered(classifier, corners, responses);
 }
 
 void LearnOnAndroid::scaning_image(Mat& result) {
 
 	Mat testing;
-	Mat image_roi;
 
 	vector<Point2i> points;
 	Mat mask = Mat::zeros(this->input_image.size(), this->input_image.type());
 
+	this->__reserve_feature_vector();
+	this->detections.clear();
+
+	if (this->descriptor_mode == DESCRIPTOR_INTEGRAL) {
+		this->integral_histogram.build(this->input_image);
+	} else if (this->descriptor_mode == DESCRIPTOR_SLIDING) {
+		this->sliding_histogram.set_image(this->input_image);
+		this->sliding_histogram.set_geometry(this->box_size, this->default_cellsize);
+	}
+
+	vector<Point> corners;
 	for (int r = 0; r < this->input_image.rows; r += this->stride) {
 		for (int c = 0; c < this->input_image.cols; c += this->stride) {
 
 			if (((r+this->box_size) < this->input_image.rows) &&
 					((c+this->box_size) < this->input_image.cols)) {
+				corners.push_back(Point(c, r));
+			}
+		}
+	}
+
+	vector<float> responses;
+	this->__classify_windows(corners, responses);
 
-				image_roi = this->input_image(Range(r, r+this->box_size),
-						                      Range(c, c+this->box_size));
+	for (size_t w = 0; w < corners.size(); w++) {
 
-				this->extract_lbp_features(image_roi);
+		int r = corners[w].y;
+		int c = corners[w].x;
+		float response = responses[w];
 
-				this->__normalize_feature_vector();
+		if(response == 1.0){
 
-				float response = this->__testing();
+			Point2i center = Point2i((c+this->box_size/2), (r+this->box_size/2));
+			points.push_back(center);
 
-				cout << response << endl;
+			rectangle(mask, Point(c, r),
+					  Point(c+this->box_size, r+this->box_size),
+					  Scalar(255, 0, 0), CV_FILLED);
 
-				if(response == 1.0){
+//			rectangle(result, Point(c, r),
+//					  Point(c+this->box_size, r+this->box_size),
+//					  Scalar(0, 0, 255));
 
-					Point2i center = Point2i((c+this->box_size/2), (r+this->box_size/2));
-					points.push_back(center);
+		}
+	}
 
-					rectangle(mask, Point(c, r),
-							  Point(c+this->box_size, r+this->box_size),
-							  Scalar(255, 0, 0), CV_FILLED);
+	this->report_prefilter_statistics();
 
-//					rectangle(result, Point(c, r),
-//							  Point(c+this->box_size, r+this->box_size),
-//							  Scalar(0, 0, 255));
+	if (!this->cascade.empty())
+		this->cascade.report_statistics();
 
-				}
-			}
-		}
+	if (!this->early_exit.empty()) {
+		LOGD("early exit: %.1f of %d kernels per window", this->early_exit.mean_kernel_evaluations(),
+			 this->early_exit.get_model().sv_count);
+		this->early_exit.reset_statistics();
 	}
 
 	int sum_x = 0;
@@ -295,13 +521,45 @@ void LearnOnAndroid::scaning_image(Mat& result) {
 	vector<Point2f> centerofMass(contours.size());
 	vector<Moments> mu(contours.size());
 
+	// result may be larger than the scanned image, e.g. one pyramid level
+	// drawn on the first: the area is measured at the scanned scale
+	double fx = (double) result.cols/this->input_image.cols;
+	double fy = (double) result.rows/this->input_image.rows;
+	bool scaled = (result.size() != this->input_image.size());
+
 	for (int i = 0; i < contours.size(); i++) {
 		vector<Point> cont(contours[i]);
 		double area = contourArea(cont);
 
 		if ((area > 3000) && (area < 60000)) {
 
-			drawContours(result, contours, i, Scalar(255, 0, 0), 2, 8, hierarchy, 0, Point());
+			// the blob's box, scored with its best window
+			Detection detection;
+			detection.box = boundingRect(cont);
+			detection.score = -FLT_MAX;
+			detection.level = 0;
+			detection.track = -1;
+			for (size_t w = 0; w < corners.size(); w++) {
+				Point center(corners[w].x + this->box_size/2, corners[w].y + this->box_size/2);
+				if (responses[w] == 1.0 && detection.box.contains(center))
+					detection.score = max(detection.score, this->window_scores[w]);
+			}
+			this->detections.push_back(detection);
+
+			// nothing to draw on, e.g. a frame that came as NV21
+			if (result.empty())
+				continue;
+
+			if (!scaled) {
+				drawContours(result, contours, i, Scalar(255, 0, 0), 2, 8, hierarchy, 0, Point());
+				continue;
+			}
+
+			vector<vector<Point> > outline(1);
+			for (size_t k = 0; k < cont.size(); k++) {
+				outline[0].push_back(Point(cvRound(cont[k].x*fx), cvRound(cont[k].y*fy)));
+			}
+			drawContours(result, outline, 0, Scalar(255, 0, 0), 2, 8);
 		}
 
 	}
@@ -18,10 +18,22 @@
 #include <vector>
 
 #include "include/lbp-adapter.hpp"
-
-#define STRIDE 16
-#define BOX_SIZE 64
-#define DEFAULT_CELLSIZE 64
+#include "integralhistogram.h"
+#include "slidinghistogram.h"
+#include "linearsvm.h"
+#include "svmcascade.h"
+#include "rbfevaluator.h"
+#include "featuremap.h"
+#include "intersectionsvm.h"
+#include "quantizedsvm.h"
+#include "classifierpolicy.h"
+#include "detectormodels.h"
+#include "scanparameters.h"
+#include "detection.h"
+
+#ifdef EMBEDDED_MODEL
+#include "embedded_model.h"
+#endif
 
 using namespace cv;
 using namespace std;
@@ -29,7 +41,7 @@ using namespace std;
 class LearnOnAndroid {
 
 private:
-	CvSVM SVM;
+	SvmModel svm_model;
 	bool has_setted_feature_vector;
 	int stride;
 	int box_size;
@@ -39,6 +51,37 @@ private:
 	VlLbp* m_lbp_model;
 	int default_cellsize;
 
+	int descriptor_mode;
+	IntegralHistogram integral_histogram;
+	SlidingHistogram sliding_histogram;
+
+	Mat vector_mean;
+	Mat vector_std;
+
+	LinearSvm prefilter;
+	bool prefilter_audit;
+	PrefilterStatistics prefilter_statistics;
+
+	SvmCascade cascade;
+
+	RbfEvaluator early_exit;
+
+	IntersectionSvm intersection;
+
+	QuantizedSvm quantized;
+
+	FeatureMap feature_map;
+	Mat window_features;
+
+	ModelBundle bundle;
+
+	bool embedded;
+	vector<float> window_scores;
+
+	double score_threshold;
+
+	vector<Detection> detections;
+
 
 public:
 	Mat input_image;
@@ -64,6 +107,70 @@ public:
 
 	void set_classification_model(string model);
 
+	void set_prefilter_model(string model);
+
+	void set_prefilter_audit(bool audit) {
+		this->prefilter_audit = audit;
+	}
+
+	bool get_prefilter_audit() const {
+		return this->prefilter_audit;
+	}
+
+	void reset_prefilter_statistics();
+
+	void report_prefilter_statistics();
+
+	// Appends a stage to the coarse-to-fine cascade; once it has a stage
+	// the cascade replaces the single model when scanning.
+	void add_cascade_stage(string model, string mean, string deviation, int cells, double threshold = 0.0) {
+		this->cascade.add_stage(model, mean, deviation, cells, threshold);
+	}
+
+	void set_cascade_threshold(int stage, double threshold) {
+		this->cascade.set_threshold(stage, threshold);
+	}
+
+	// Classifies windows with an early-exit evaluation of the RBF model;
+	// the decisions match SvmModel::predict exactly. SvmModel sums the
+	// kernels in double precision, CvSVM::predict in float, so windows on
+	// the decision boundary can still differ from CvSVM.
+	void set_early_exit_model(string model, int clusters = RBF_DEFAULT_CLUSTERS);
+
+	// Classifies windows with an intersection-kernel model on the raw
+	// descriptors, mean.txt and std.txt are not used.
+	void set_intersection_model(string model) {
+		this->intersection.load(model);
+	}
+
+	// Classifies windows with an int8 copy of the RBF model; the raw
+	// descriptors are quantized with the given mean and std.
+	void set_quantized_model(string model, string mean, string deviation);
+
+	// Classifies all windows with the model compiled into the library
+	// (ndk-build EMBED_MODEL=1), nothing is read from the sdcard.
+	void set_embedded_model(bool embedded);
+
+	// Classifies all windows of a frame with a model bundle, through the
+	// backend its type names (see classifierpolicy.h and tools/make_bundle.cpp).
+	void set_model_bundle(string bundle) {
+		this->bundle.load(bundle);
+	}
+
+	// Classifies all windows of a frame at once with a linearised model
+	// (see tools/feature_map.cpp) instead of the RBF model.
+	void set_feature_map(string feature_map) {
+		this->feature_map.load(feature_map);
+	}
+
+	// Takes the models read once by a DetectorSession instead of loading
+	// them from the sdcard; only the Mat headers are copied.
+	void use_models(const DetectorModels& models);
+
+	// Stride, window and cell size and score threshold; the feature buffer
+	// only grows when the window descriptor gets longer.
+	void set_scan_parameters(const ScanParameters& parameters);
+
 
 	void init_feature_vector();
 
@@ -73,8 +180,16 @@ public:
 
 	void save_feature(string output_filename);
 
+	// Scans input_image and draws the faces' outlines on result, which may
+	// be empty to only collect them.
 	void scaning_image(Mat& result);
 
+	// The faces of the last scaning_image(), in the scanned image's pixels,
+	// level 0 and no track.
+	const vector<Detection>& get_detections() const {
+		return this->detections;
+	}
+
 	int get_box_size() const {
 		return this->box_size;
 	}
@@ -99,6 +214,14 @@ public:
 		this->stride = stride;
 	}
 
+	int get_descriptor_mode() const {
+		return this->descriptor_mode;
+	}
+
+	void set_descriptor_mode(int mode) {
+		this->descriptor_mode = mode;
+	}
+
 private:
 
 	void __load_vector(string filename, float* vector);
@@ -111,9 +234,59 @@ private:
 
 	void __set_feature_vector(int dimension);
 
+	void __reserve_feature_vector();
+
 	void __printing_feature_vector(float* vector);
 
-	float __testing();
+	void __extract_window_features(int row, int col);
+
+	void __init_prefilter();
+
+	void __classify_windows(const vector<Point>& corners, vector<float>& responses);
+
+	void __gather_window_features(const vector<Point>& corners, bool normalize);
+
+	// The scan itself, one instantiation per classifier policy (see
+	// classifierpolicy.h): the frame's descriptors are gathered into one
+	// batch, scored, and compared with the score threshold.
+	template <class Classifier>
+	void __score_windows(Classifier& classifier, const vector<Point>& corners, vector<float>& responses) {
+
+		int n = (int) corners.size();
+		const float* descriptors = NULL;
+
+		if (classifier.dimension() > 0) {
+			if (classifier.dimension() != this->dimension_histogram)
+				CV_Error(CV_StsBadArg, "The model does not match the window descriptor");
+
+			this->__gather_window_features(corners, classifier.normalized());
+			if (n > 0)
+				descriptors = this->window_features.ptr<float>(0);
+		}
+
+		this->window_scores.resize(n);
+		if (n > 0)
+			classifier.score(descriptors, n, &this->window_scores[0]);
+
+		for (int w = 0; w < n; w++) {
+			responses[w] = this->window_scores[w] > this->score_threshold ? 1.0 : -1.0;
+		}
+	}
+
+	// The default RBF model or its early-exit evaluation, behind the linear
+	// pre-filter when there is one.
+	template <class Classifier>
+	void __score_prefiltered(Classifier& classifier, const vector<Point>& corners, vector<float>& responses) {
+
+		if (this->prefilter.empty()) {
+			this->__score_windows(classifier, corners, responses);
+			return;
+		}
+
+		PrefilterPolicy<Classifier> prefiltered(this->prefilter, classifier, this->prefilter_statistics,
+												this->prefilter_audit, (float) this->score_threshold);
+		this->__score_windows(prefiltered, corners, responses);
+	}
 
 };
 
@@ -0,0 +1,163 @@
+/*
+ * linearsvm.cpp
+ */
+
+#include "linearsvm.h"
+
+#include <algorithm>
+#include <iostream>
+
+LinearSvm::LinearSvm() {
+
+	this->bias = 0.0f;
+	this->threshold = 0.0f;
+
+}
+
+LinearSvm::LinearSvm(string filename) {
+
+	this->bias = 0.0f;
+	this->threshold = 0.0f;
+
+	this->load(filename);
+
+}
+
+LinearSvm::~LinearSvm() {
+}
+
+void LinearSvm::load(string filename, int dimension) {
+
+	FileStorage fs(filename, FileStorage::READ);
+	if (!fs.isOpened())
+		CV_Error(CV_StsError, "Could not open the linear model " + filename);
+
+	this->read(fs["linear_svm"]);
+	this->__check(filename, dimension);
+}
+
+void LinearSvm::load(const char* data, size_t length, int dimension) {
+
+	FileStorage fs(string(data, length), FileStorage::READ + FileStorage::MEMORY);
+	if (!fs.isOpened())
+		CV_Error(CV_StsError, "Could not parse the linear model");
+
+	this->read(fs["linear_svm"]);
+	this->__check("in memory", dimension);
+}
+
+void LinearSvm::__check(string name, int dimension) const {
+
+	if (this->weights.empty())
+		CV_Error(CV_StsParseError, "No weights in the linear model " + name);
+	if (dimension > 0 && this->weights.cols != dimension)
+		CV_Error(CV_StsBadArg, "The linear model " + name + " does not fit the descriptor dimension");
+}
+
+void LinearSvm::read(const FileNode& node) {
+
+	node["weights"] >> this->weights;
+	this->bias = (float) node["bias"];
+	this->threshold = (float) node["threshold"];
+
+	this->weights = this->weights.reshape(1, 1);
+	if (this->weights.type() != CV_32FC1)
+		this->weights.convertTo(this->weights, CV_32F);
+}
+
+void LinearSvm::save(string filename) const {
+
+	FileStorage fs(filename, FileStorage::WRITE);
+	if (!fs.isOpened())
+		CV_Error(CV_StsError, "Could not write the linear model " + filename);
+
+	this->write(fs, "linear_svm");
+}
+
+void LinearSvm::write(FileStorage& fs, string name) const {
+
+	fs << name << "{";
+	fs << "weights" << this->weights;
+	fs << "bias" << this->bias;
+	fs << "threshold" << this->threshold;
+	fs << "}";
+}
+
+float LinearSvm::score(const float* x) const {
+
+	const float* w = this->weights.ptr<float>(0);
+	float s = this->bias;
+
+	for (int i = 0; i < this->weights.cols; i++) {
+		s += w[i]*x[i];
+	}
+
+	return s;
+}
+
+void LinearSvm::train(const Mat& features, const Mat& labels, double target_recall, double C) {
+
+	this->fit(features, labels, C);
+	this->calibrate(features, labels, target_recall);
+}
+
+void LinearSvm::fit(const Mat& features, const Mat& labels, double C) {
+
+	CvSVMParams params;
+	params.svm_type = CvSVM::C_SVC;
+	params.kernel_type = CvSVM::LINEAR;
+	params.C = C;
+	params.term_crit = cvTermCriteria(CV_TERMCRIT_ITER | CV_TERMCRIT_EPS, 10000, 1e-6);
+
+	CvSVM svm;
+	svm.train(features, labels, Mat(), Mat(), params);
+
+	// The decision function is linear, so it is recovered from predictions:
+	// its value at 0 gives the bias and at every unit vector one weight.
+	// CvSVM sorts the labels, the face label 1 comes second and wins when the
+	// decision is not positive, hence the change of sign.
+	int d = features.cols;
+	Mat sample = Mat::zeros(1, d, CV_32FC1);
+	float origin = svm.predict(sample, true);
+
+	this->weights.create(1, d, CV_32FC1);
+	for (int i = 0; i < d; i++) {
+		sample.at<float>(i) = 1.0f;
+		this->weights.at<float>(i) = -(svm.predict(sample, true) - origin);
+		sample.at<float>(i) = 0.0f;
+	}
+	this->bias = -origin;
+	this->threshold = 0.0f;
+}
+
+void LinearSvm::calibrate(const Mat& features, const Mat& labels, double target_recall) {
+
+	vector<float> faces;
+	vector<float> others;
+
+	for (int i = 0; i < features.rows; i++) {
+		float s = this->score(features.ptr<float>(i));
+		if (labels.at<float>(i) == 1.0f)
+			faces.push_back(s);
+		else
+			others.push_back(s);
+	}
+
+	if (faces.empty())
+		CV_Error(CV_StsBadArg, "Calibration needs at least one face sample");
+
+	sort(faces.begin(), faces.end());
+	int keep = (int)(target_recall*faces.size() + 0.5);
+	keep = max(1, min(keep, (int)faces.size()));
+	this->threshold = faces[faces.size() - keep];
+
+	int rejected = 0;
+	for (size_t i = 0; i < others.size(); i++) {
+		if (others[i] < this->threshold)
+			rejected++;
+	}
+
+	cout << "linear pre-filter: threshold " << this->threshold
+		 << ", keeps " << keep << "/" << faces.size() << " faces, rejects "
+		 << rejected << "/" << others.size() << " non-faces" << endl;
+}
@@ -0,0 +1,78 @@
+/*
+ * linearsvm.h
+ */
+
+#ifndef LINEARSVM_H_
+#define LINEARSVM_H_
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/ml/ml.hpp>
+
+#include <string>
+
+#include "svmmodel.h"
+
+// fraction of the training faces a pre-filter keeps by default
+#define PREFILTER_TARGET_RECALL 0.995
+
+using namespace cv;
+using namespace std;
+
+// A linear SVM kept as one weight vector: score(x) = w.x + b, oriented so
+// that faces score high. Used as a cheap rejection stage in front of the
+// RBF model, windows scoring below threshold are dropped. Training picks
+// the threshold that keeps a target fraction of the training faces.
+class LinearSvm {
+
+public:
+	Mat weights;
+	float bias;
+	float threshold;
+
+public:
+	LinearSvm();
+
+	LinearSvm(string filename);
+
+	virtual ~LinearSvm();
+
+	// Raises CV_StsBadArg unless the weights are dimension long; 0 takes
+	// any length, for tools that read the model on its own.
+	void load(string filename, int dimension = 0);
+
+	// The same from a file read into memory.
+	void load(const char* data, size_t length, int dimension = 0);
+
+	void save(string filename) const;
+
+	void read(const FileNode& node);
+
+	void write(FileStorage& fs, string name) const;
+
+	bool empty() const {
+		return this->weights.empty();
+	}
+
+	int get_var_count() const {
+		return this->weights.cols;
+	}
+
+	void train(const Mat& features, const Mat& labels,
+			   double target_recall = PREFILTER_TARGET_RECALL, double C = 1.0);
+
+	void fit(const Mat& features, const Mat& labels, double C = 1.0);
+
+	void calibrate(const Mat& features, const Mat& labels, double target_recall);
+
+	float score(const float* x) const;
+
+	bool accept(const float* x) const {
+		return this->score(x) >= this->threshold;
+	}
+
+private:
+	void __check(string name, int dimension) const;
+
+};
+
+#endif /* LINEARSVM_H_ */
@@ -0,0 +1,80 @@
+/*
+ * mappedfile.cpp
+ */
+
+#include "mappedfile.h"
+
+#include <opencv2/core/core.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile() {
+
+	this->base = NULL;
+	this->mapped_length = 0;
+	this->begin = NULL;
+	this->length = 0;
+
+}
+
+MappedFile::~MappedFile() {
+	this->release();
+}
+
+void MappedFile::map(int fd, off_t offset, size_t length) {
+
+	this->release();
+
+	if (length == 0)
+		CV_Error(CV_StsBadArg, "Nothing to map");
+
+	// mmap wants a page aligned offset, map from the page start and skip in
+	off_t page = (off_t) sysconf(_SC_PAGESIZE);
+	off_t aligned = offset - offset % page;
+	size_t skip = (size_t) (offset - aligned);
+
+	void* base = mmap(NULL, length + skip, PROT_READ, MAP_PRIVATE, fd, aligned);
+	if (base == MAP_FAILED)
+		CV_Error(CV_StsError, "Could not map the model file");
+
+	this->base = base;
+	this->mapped_length = length + skip;
+	this->begin = (const char*) base + skip;
+	this->length = length;
+}
+
+void MappedFile::map(string filename) {
+
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		CV_Error(CV_StsError, "Could not open " + filename);
+
+	struct stat status;
+	if (fstat(fd, &status) != 0 || status.st_size == 0) {
+		close(fd);
+		CV_Error(CV_StsError, "Could not read " + filename);
+	}
+
+	try {
+		this->map(fd, 0, (size_t) status.st_size);
+	} catch (...) {
+		close(fd);
+		throw;
+	}
+
+	close(fd);
+}
+
+void MappedFile::release() {
+
+	if (this->base != NULL)
+		munmap(this->base, this->mapped_length);
+
+	this->base = NULL;
+	this->mapped_length = 0;
+	this->begin = NULL;
+	this->length = 0;
+}
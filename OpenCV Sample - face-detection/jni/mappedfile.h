@@ -0,0 +1,56 @@
+/*
+ * mappedfile.h
+ */
+
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <sys/types.h>
+
+#include <string>
+
+using namespace std;
+
+// A read-only mmap of (fd, offset, length), e.g. an uncompressed entry of
+// the APK as given by AssetFileDescriptor, or of a whole file. The offset
+// need not be page aligned. The mapping lives until release() or the
+// destructor; the fd can be closed as soon as map() returns.
+class MappedFile {
+
+private:
+	void* base;
+	size_t mapped_length;
+	const char* begin;
+	size_t length;
+
+public:
+	MappedFile();
+
+	virtual ~MappedFile();
+
+	void map(int fd, off_t offset, size_t length);
+
+	void map(string filename);
+
+	void release();
+
+	bool empty() const {
+		return this->begin == NULL;
+	}
+
+	const char* data() const {
+		return this->begin;
+	}
+
+	size_t size() const {
+		return this->length;
+	}
+
+private:
+	MappedFile(const MappedFile&);
+
+	MappedFile& operator=(const MappedFile&);
+
+};
+
+#endif /* MAPPEDFILE_H_ */
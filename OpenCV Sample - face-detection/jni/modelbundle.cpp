@@ -0,0 +1,188 @@
+/*
+ * modelbundle.cpp
+ */
+
+#include "modelbundle.h"
+
+ModelBundle::ModelBundle() {
+
+	this->type = BUNDLE_RBF;
+
+}
+
+ModelBundle::ModelBundle(string filename) {
+
+	this->type = BUNDLE_RBF;
+
+	this->load(filename);
+
+}
+
+ModelBundle::~ModelBundle() {
+}
+
+int ModelBundle::type_from_name(string name) {
+
+	if (name == "rbf")
+		return BUNDLE_RBF;
+	if (name == "linear")
+		return BUNDLE_LINEAR;
+	if (name == "intersection")
+		return BUNDLE_INTERSECTION;
+	if (name == "quantized")
+		return BUNDLE_QUANTIZED;
+
+	CV_Error(CV_StsBadArg, "Unknown model bundle type " + name);
+	return -1;
+}
+
+string ModelBundle::type_name(int type) {
+
+	switch (type) {
+	case BUNDLE_RBF:
+		return "rbf";
+	case BUNDLE_LINEAR:
+		return "linear";
+	case BUNDLE_INTERSECTION:
+		return "intersection";
+	case BUNDLE_QUANTIZED:
+		return "quantized";
+	}
+
+	CV_Error(CV_StsBadArg, "Unknown model bundle type");
+	return "";
+}
+
+int ModelBundle::get_descriptor_dimension() const {
+
+	switch (this->type) {
+	case BUNDLE_RBF:
+	case BUNDLE_LINEAR:
+		return this->projection.get_input_dimension();
+	case BUNDLE_INTERSECTION:
+		return this->intersection.get_var_count();
+	case BUNDLE_QUANTIZED:
+		return this->quantized.var_count;
+	}
+
+	return 0;
+}
+
+void ModelBundle::assign(string model, string mean, string deviation, int type) {
+
+	this->type = type;
+
+	if (type == BUNDLE_INTERSECTION) {
+		this->intersection.load(model);
+		return;
+	}
+
+	load_text_vector(mean, this->mean);
+	load_text_vector(deviation, this->deviation);
+
+	if (type == BUNDLE_LINEAR) {
+		this->linear.load(model);
+		this->projection.normalization(this->mean, this->deviation);
+		if (this->linear.weights.cols != this->mean.cols)
+			CV_Error(CV_StsBadArg, "mean and std do not match the model");
+		return;
+	}
+
+	this->svm.load(model);
+
+	if (type == BUNDLE_QUANTIZED) {
+		this->quantized.quantize(this->svm, this->mean, this->deviation);
+	} else {
+		this->projection.normalization(this->mean, this->deviation);
+		if (this->projection.get_output_dimension() != this->svm.var_count)
+			CV_Error(CV_StsBadArg, "mean and std do not match the model");
+	}
+}
+
+void ModelBundle::load(string filename) {
+
+	FileStorage fs(filename, FileStorage::READ);
+	if (!fs.isOpened())
+		CV_Error(CV_StsError, "Could not open the model bundle " + filename);
+
+	this->read(fs["model_bundle"]);
+}
+
+void ModelBundle::load(const char* data, size_t length) {
+
+	// FileStorage parses a NUL terminated string, which a mapped region is not
+	FileStorage fs(string(data, length), FileStorage::READ + FileStorage::MEMORY);
+	if (!fs.isOpened())
+		CV_Error(CV_StsError, "Could not parse the model bundle");
+
+	this->read(fs["model_bundle"]);
+}
+
+void ModelBundle::read(const FileNode& node) {
+
+	if (node.empty())
+		CV_Error(CV_StsParseError, "No model_bundle node");
+
+	this->type = type_from_name((string) node["type"]);
+
+	switch (this->type) {
+	case BUNDLE_RBF:
+		this->projection.read(node["projection"]);
+		this->svm.read(node["svm"]);
+		if (this->projection.get_output_dimension() != this->svm.var_count)
+			CV_Error(CV_StsParseError, "The projection does not match the model");
+		break;
+
+	case BUNDLE_LINEAR:
+		this->projection.read(node["projection"]);
+		this->linear.read(node["linear_svm"]);
+		if (this->projection.get_output_dimension() != this->linear.weights.cols)
+			CV_Error(CV_StsParseError, "The projection does not match the model");
+		break;
+
+	case BUNDLE_INTERSECTION:
+		this->intersection.read(node["intersection_svm"]);
+		break;
+
+	case BUNDLE_QUANTIZED:
+		this->svm.read(node["svm"]);
+		node["mean"] >> this->mean;
+		node["deviation"] >> this->deviation;
+		this->quantized.quantize(this->svm, this->mean, this->deviation);
+		break;
+	}
+}
+
+void ModelBundle::save(string filename) const {
+
+	FileStorage fs(filename, FileStorage::WRITE);
+	if (!fs.isOpened())
+		CV_Error(CV_StsError, "Could not write the model bundle " + filename);
+
+	fs << "model_bundle" << "{";
+	fs << "type" << type_name(this->type);
+
+	switch (this->type) {
+	case BUNDLE_RBF:
+		this->projection.write(fs, "projection");
+		this->svm.write(*fs, "svm");
+		break;
+
+	case BUNDLE_LINEAR:
+		this->projection.write(fs, "projection");
+		this->linear.write(fs, "linear_svm");
+		break;
+
+	case BUNDLE_INTERSECTION:
+		this->intersection.write(fs, "intersection_svm");
+		break;
+
+	case BUNDLE_QUANTIZED:
+		this->svm.write(*fs, "svm");
+		fs << "mean" << this->mean;
+		fs << "deviation" << this->deviation;
+		break;
+	}
+
+	fs << "}";
+}
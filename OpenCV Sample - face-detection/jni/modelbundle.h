@@ -0,0 +1,81 @@
+/*
+ * modelbundle.h
+ */
+
+#ifndef MODELBUNDLE_H_
+#define MODELBUNDLE_H_
+
+#include <opencv2/core/core.hpp>
+
+#include <string>
+
+#include "featureprojection.h"
+#include "svmmodel.h"
+#include "linearsvm.h"
+#include "intersectionsvm.h"
+#include "quantizedsvm.h"
+
+// what a bundle classifies with, see classifierpolicy.h
+#define BUNDLE_RBF 0			// projection + svm
+#define BUNDLE_LINEAR 1			// projection + linear_svm
+#define BUNDLE_INTERSECTION 2	// intersection_svm on the raw descriptors
+#define BUNDLE_QUANTIZED 3		// svm + mean + deviation, quantized when loaded
+
+using namespace cv;
+using namespace std;
+
+// Everything needed to classify a raw window descriptor, in one
+// FileStorage file instead of svm_model.xml, mean.txt and std.txt:
+//
+//   model_bundle:
+//     type: rbf | linear | intersection | quantized
+//     projection: { transform, offset }   raw descriptor -> model space
+//     svm: { ... }                        CvSVM layout, see SvmModel
+//
+// with linear_svm, intersection_svm or mean/deviation in place of the
+// nodes the type does not use.
+class ModelBundle {
+
+public:
+	int type;
+	FeatureProjection projection;
+	SvmModel svm;
+	LinearSvm linear;
+	IntersectionSvm intersection;
+	QuantizedSvm quantized;
+	Mat mean;
+	Mat deviation;
+
+public:
+	ModelBundle();
+
+	ModelBundle(string filename);
+
+	virtual ~ModelBundle();
+
+	// wraps the files the detector has always used
+	void assign(string model, string mean, string deviation, int type = BUNDLE_RBF);
+
+	void load(string filename);
+
+	// Reads a bundle held in memory, e.g. mapped from the APK (see
+	// mappedfile.h), with the same layout load() reads from a file.
+	void load(const char* data, size_t length);
+
+	void read(const FileNode& node);
+
+	void save(string filename) const;
+
+	bool empty() const {
+		return this->get_descriptor_dimension() == 0;
+	}
+
+	int get_descriptor_dimension() const;
+
+	static int type_from_name(string name);
+
+	static string type_name(int type);
+
+};
+
+#endif /* MODELBUNDLE_H_ */
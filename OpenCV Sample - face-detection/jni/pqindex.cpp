@@ -0,0 +1,375 @@
+/*
+ * pqindex.cpp
+ */
+
+#include "pqindex.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <fstream>
+
+#define PQ_MAGIC 0x31515150 /* "PQQ1" */
+
+PQIndex::PQIndex() {
+
+	this->subspaces = PQ_DEFAULT_SUBSPACES;
+	this->centroids = PQ_MAX_CENTROIDS;
+	this->dimension = 0;
+
+}
+
+PQIndex::PQIndex(int subspaces, int centroids) {
+
+	if (subspaces <= 0 || centroids <= 1 || centroids > PQ_MAX_CENTROIDS)
+		CV_Error(CV_StsBadArg, "PQ index needs at least one subspace and 2 to 256 centroids");
+
+	this->subspaces = subspaces;
+	this->centroids = centroids;
+	this->dimension = 0;
+
+}
+
+PQIndex::~PQIndex() {
+	this->clear();
+}
+
+void PQIndex::clear() {
+
+	this->codebooks.clear();
+	this->offsets.clear();
+	this->codes.release();
+	this->dimension = 0;
+
+}
+
+void PQIndex::hellinger(const Mat& src, Mat& dst) {
+
+	src.convertTo(dst, CV_32F);
+
+	for (int i = 0; i < dst.rows; i++) {
+		float* row = dst.ptr<float>(i);
+		double sum = 0.0;
+		for (int j = 0; j < dst.cols; j++) {
+			sum += row[j];
+		}
+		float scale = sum > 0.0 ? (float)(1.0/sum) : 0.0f;
+		for (int j = 0; j < dst.cols; j++) {
+			row[j] = sqrtf(max(row[j]*scale, 0.0f));
+		}
+	}
+}
+
+void PQIndex::__set_offsets() {
+
+	// subspaces differ by at most one dimension when they do not divide it
+	this->offsets.resize(this->subspaces + 1);
+	for (int m = 0; m <= this->subspaces; m++) {
+		this->offsets[m] = (int)((int64)m*this->dimension/this->subspaces);
+	}
+}
+
+void PQIndex::build(const Mat& descriptors) {
+	this->train(descriptors);
+	this->add(descriptors);
+}
+
+void PQIndex::train(const Mat& descriptors) {
+
+	if (descriptors.cols < this->subspaces)
+		CV_Error(CV_StsBadArg, "Descriptors are shorter than the number of subspaces");
+	// load() takes an index of fewer than 2 centroids for a broken file
+	if (descriptors.rows < 2)
+		CV_Error(CV_StsBadArg, "Training a PQ index needs at least 2 descriptors");
+
+	this->clear();
+	this->dimension = descriptors.cols;
+	this->__set_offsets();
+
+	Mat sample;
+	if (descriptors.rows > PQ_MAX_TRAINING) {
+		RNG rng;
+		sample.create(PQ_MAX_TRAINING, descriptors.cols, descriptors.type());
+		for (int i = 0; i < PQ_MAX_TRAINING; i++) {
+			descriptors.row(rng.uniform(0, descriptors.rows)).copyTo(sample.row(i));
+		}
+	} else {
+		sample = descriptors;
+	}
+
+	Mat embedded;
+	hellinger(sample, embedded);
+
+	int k = min(this->centroids, embedded.rows);
+
+	for (int m = 0; m < this->subspaces; m++) {
+		Mat data = embedded.colRange(this->offsets[m], this->offsets[m+1]).clone();
+		Mat labels;
+		Mat centers;
+		kmeans(data, k, labels, TermCriteria(CV_TERMCRIT_ITER | CV_TERMCRIT_EPS, 20, 1e-4),
+			   1, KMEANS_PP_CENTERS, centers);
+		this->codebooks.push_back(centers);
+	}
+}
+
+// Encodes a block of embedded rows; every row only writes its own codes.
+class PQEncoder : public ParallelLoopBody {
+public:
+	PQEncoder(const Mat& embedded, const vector<Mat>& codebooks,
+			  const vector<int>& offsets, Mat& codes)
+		: embedded(embedded), codebooks(codebooks), offsets(offsets), codes(codes) {}
+
+	void operator()(const Range& range) const {
+		for (int i = range.start; i < range.end; i++) {
+			const float* row = this->embedded.ptr<float>(i);
+			uchar* code = this->codes.ptr<uchar>(i);
+			for (size_t m = 0; m < this->codebooks.size(); m++) {
+				const Mat& centers = this->codebooks[m];
+				const float* x = row + this->offsets[m];
+				int best = 0;
+				float best_distance = FLT_MAX;
+				for (int c = 0; c < centers.rows; c++) {
+					const float* y = centers.ptr<float>(c);
+					float distance = 0.0f;
+					for (int j = 0; j < centers.cols; j++) {
+						float d = x[j] - y[j];
+						distance += d*d;
+					}
+					if (distance < best_distance) {
+						best_distance = distance;
+						best = c;
+					}
+				}
+				code[m] = (uchar)best;
+			}
+		}
+	}
+
+private:
+	const Mat& embedded;
+	const vector<Mat>& codebooks;
+	const vector<int>& offsets;
+	Mat& codes;
+};
+
+void PQIndex::add(const Mat& descriptors) {
+
+	if (this->codebooks.empty())
+		CV_Error(CV_StsError, "PQ index must be trained before adding descriptors");
+	if (descriptors.cols != this->dimension)
+		CV_Error(CV_StsBadArg, "Descriptor dimension does not match the index");
+
+	Mat embedded;
+	Mat codes(descriptors.rows, this->subspaces, CV_8UC1);
+
+	hellinger(descriptors, embedded);
+	parallel_for_(Range(0, embedded.rows),
+				  PQEncoder(embedded, this->codebooks, this->offsets, codes));
+
+	this->codes.push_back(codes);
+}
+
+void PQIndex::__distance_tables(const float* query, Mat& tables) const {
+
+	tables = Mat::zeros(this->subspaces, PQ_MAX_CENTROIDS, CV_32FC1);
+
+	for (int m = 0; m < this->subspaces; m++) {
+		const Mat& centers = this->codebooks[m];
+		const float* x = query + this->offsets[m];
+		float* table = tables.ptr<float>(m);
+		for (int c = 0; c < centers.rows; c++) {
+			const float* y = centers.ptr<float>(c);
+			float distance = 0.0f;
+			for (int j = 0; j < centers.cols; j++) {
+				float d = x[j] - y[j];
+				distance += d*d;
+			}
+			table[c] = distance;
+		}
+	}
+}
+
+// Scores a block of coded rows with one table lookup per subspace.
+class PQScanner : public ParallelLoopBody {
+public:
+	PQScanner(const Mat& codes, const Mat& tables, float* distances)
+		: codes(codes), tables(tables), distances(distances) {}
+
+	void operator()(const Range& range) const {
+		const float* table = this->tables.ptr<float>(0);
+		int subspaces = this->codes.cols;
+		for (int i = range.start; i < range.end; i++) {
+			const uchar* code = this->codes.ptr<uchar>(i);
+			float distance = 0.0f;
+			for (int m = 0; m < subspaces; m++) {
+				distance += table[m*PQ_MAX_CENTROIDS + code[m]];
+			}
+			this->distances[i] = distance;
+		}
+	}
+
+private:
+	const Mat& codes;
+	const Mat& tables;
+	float* distances;
+};
+
+void PQIndex::__approximate_distances(const Mat& tables, Mat& distances) const {
+
+	distances.create(1, this->codes.rows, CV_32FC1);
+	parallel_for_(Range(0, this->codes.rows),
+				  PQScanner(this->codes, tables, distances.ptr<float>(0)));
+}
+
+void PQIndex::search(const Mat& query, int k, vector<lbp::Match>& matches) const {
+
+	matches.clear();
+	if (this->codes.empty())
+		return;
+
+	Mat embedded;
+	Mat tables;
+	Mat distances;
+
+	hellinger(query.reshape(1, 1), embedded);
+	this->__distance_tables(embedded.ptr<float>(0), tables);
+	this->__approximate_distances(tables, distances);
+
+	lbp::top_k(distances, k, matches);
+}
+
+void PQIndex::search(const Mat& query, int k, int rerank, const Mat& originals,
+					 vector<lbp::Match>& matches) const {
+
+	if (originals.rows != this->codes.rows)
+		CV_Error(CV_StsBadArg, "Originals must hold one histogram per indexed row");
+	if (originals.type() != CV_32FC1 && originals.type() != CV_16UC1)
+		CV_Error(CV_StsBadArg, "Originals must be CV_32FC1 or CV_16UC1.");
+
+	vector<lbp::Match> candidates;
+	this->search(query, max(k, rerank), candidates);
+
+	Mat probe;
+	query.reshape(1, 1).convertTo(probe, CV_32F);
+	const float* p = probe.ptr<float>(0);
+
+	for (size_t i = 0; i < candidates.size(); i++) {
+		int row = candidates[i].index;
+		if (originals.type() == CV_32FC1)
+			candidates[i].distance = lbp::chi_square_f32(p, originals.ptr<float>(row), this->dimension);
+		else
+			candidates[i].distance = lbp::chi_square_u16(p, originals.ptr<unsigned short>(row), this->dimension);
+	}
+
+	Mat distances(1, (int)candidates.size(), CV_32FC1);
+	for (size_t i = 0; i < candidates.size(); i++) {
+		distances.at<float>(i) = candidates[i].distance;
+	}
+
+	lbp::top_k(distances, k, matches);
+	for (size_t i = 0; i < matches.size(); i++) {
+		matches[i].index = candidates[matches[i].index].index;
+	}
+}
+
+void PQIndex::evaluate(const Mat& queries, const Mat& originals, int k,
+					   const vector<int>& reranks, vector<PQRecall>& report) const {
+
+	report.clear();
+
+	vector<vector<int> > truth(queries.rows);
+	for (int q = 0; q < queries.rows; q++) {
+		vector<lbp::Match> exact;
+		Mat probe;
+		queries.row(q).convertTo(probe, CV_32F);
+		lbp::chi_square_top_k(probe, originals, k, exact);
+		for (size_t i = 0; i < exact.size(); i++) {
+			truth[q].push_back(exact[i].index);
+		}
+	}
+
+	for (size_t r = 0; r < reranks.size(); r++) {
+		int found = 0;
+		int expected = 0;
+		int64 ticks = 0;
+
+		for (int q = 0; q < queries.rows; q++) {
+			vector<lbp::Match> matches;
+			int64 start = getTickCount();
+			if (reranks[r] > 0)
+				this->search(queries.row(q), k, reranks[r], originals, matches);
+			else
+				this->search(queries.row(q), k, matches);
+			ticks += getTickCount() - start;
+
+			for (size_t i = 0; i < matches.size(); i++) {
+				if (find(truth[q].begin(), truth[q].end(), matches[i].index) != truth[q].end())
+					found++;
+			}
+			expected += truth[q].size();
+		}
+
+		PQRecall recall;
+		recall.rerank = reranks[r];
+		recall.recall = expected > 0 ? (double)found/expected : 0.0;
+		recall.milliseconds = queries.rows > 0 ?
+				ticks*1000.0/getTickFrequency()/queries.rows : 0.0;
+		report.push_back(recall);
+	}
+}
+
+void PQIndex::save(string filename) const {
+
+	ofstream fout(filename.c_str(), ios::out | ios::binary | ios::trunc);
+	if (!fout)
+		CV_Error(CV_StsError, "Could not write the PQ index " + filename);
+
+	int header[5] = {PQ_MAGIC, this->dimension, this->subspaces,
+					 this->codebooks.empty() ? 0 : this->codebooks[0].rows, this->codes.rows};
+	fout.write((const char*)header, sizeof(header));
+
+	for (size_t m = 0; m < this->codebooks.size(); m++) {
+		const Mat& centers = this->codebooks[m];
+		fout.write((const char*)centers.ptr<float>(0), centers.total()*sizeof(float));
+	}
+
+	if (!this->codes.empty())
+		fout.write((const char*)this->codes.ptr<uchar>(0), this->codes.total());
+
+	fout.close();
+}
+
+void PQIndex::load(string filename) {
+
+	ifstream fin(filename.c_str(), ios::in | ios::binary);
+	if (!fin)
+		CV_Error(CV_StsError, "Could not read the PQ index " + filename);
+
+	int header[5];
+	fin.read((char*)header, sizeof(header));
+	if (!fin || header[0] != PQ_MAGIC || header[2] <= 0 ||
+			header[3] <= 1 || header[3] > PQ_MAX_CENTROIDS || header[4] < 0)
+		CV_Error(CV_StsParseError, "Invalid PQ index " + filename);
+	// as train(): every subspace keeps at least one dimension
+	if (header[1] < header[2])
+		CV_Error(CV_StsParseError, "Invalid PQ index " + filename + ": dimension smaller than the number of subspaces");
+
+	this->clear();
+	this->dimension = header[1];
+	this->subspaces = header[2];
+	this->centroids = header[3];
+	this->__set_offsets();
+
+	for (int m = 0; m < this->subspaces; m++) {
+		Mat centers(this->centroids, this->offsets[m+1] - this->offsets[m], CV_32FC1);
+		fin.read((char*)centers.ptr<float>(0), centers.total()*sizeof(float));
+		this->codebooks.push_back(centers);
+	}
+
+	if (header[4] > 0) {
+		this->codes.create(header[4], this->subspaces, CV_8UC1);
+		fin.read((char*)this->codes.ptr<uchar>(0), this->codes.total());
+	}
+
+	if (!fin)
+		CV_Error(CV_StsParseError, "Truncated PQ index " + filename);
+}
@@ -0,0 +1,105 @@
+/*
+ * pqindex.h
+ */
+
+#ifndef PQINDEX_H_
+#define PQINDEX_H_
+
+#include <opencv2/core/core.hpp>
+
+#include <string>
+#include <vector>
+
+#include "chisquare.h"
+
+// 64 subspaces split an 8x8 grid of 58-bin histograms into one cell each
+#define PQ_DEFAULT_SUBSPACES 64
+#define PQ_MAX_CENTROIDS 256
+// rows sampled from the training set for each subspace k-means
+#define PQ_MAX_TRAINING 65536
+
+using namespace cv;
+using namespace std;
+
+// recall@k and mean search time for one re-ranking depth
+struct PQRecall {
+	int rerank;
+	double recall;
+	double milliseconds;
+};
+
+// Approximate nearest neighbour index for LBP histograms.
+//
+// Rows are L1 normalised and square rooted (Hellinger embedding), so the
+// chi-square distance between histograms becomes close to the squared L2
+// distance between embedded rows. Each embedded row is cut into subspaces,
+// and each subspace is stored as the one byte index of its nearest k-means
+// centroid. A query builds one table of distances to every centroid per
+// subspace and scores a row with one lookup per subspace. The best rerank
+// candidates are then re-scored with the exact chi-square distance against
+// the original histograms, which the index itself does not keep.
+class PQIndex {
+
+private:
+	int subspaces;
+	int centroids;
+	int dimension;
+	vector<int> offsets;
+	vector<Mat> codebooks;
+	Mat codes;
+
+public:
+	PQIndex();
+
+	PQIndex(int subspaces, int centroids = PQ_MAX_CENTROIDS);
+
+	virtual ~PQIndex();
+
+	void build(const Mat& descriptors);
+
+	void train(const Mat& descriptors);
+
+	void add(const Mat& descriptors);
+
+	void clear();
+
+	void search(const Mat& query, int k, vector<lbp::Match>& matches) const;
+
+	void search(const Mat& query, int k, int rerank, const Mat& originals,
+				vector<lbp::Match>& matches) const;
+
+	// recall@k of the index against exact chi-square search over
+	// originals, for each re-ranking depth (0 for none); see
+	// tools/pq_index.cpp
+	void evaluate(const Mat& queries, const Mat& originals, int k,
+				  const vector<int>& reranks, vector<PQRecall>& report) const;
+
+	void save(string filename) const;
+
+	void load(string filename);
+
+	int get_count() const {
+		return this->codes.rows;
+	}
+
+	int get_dimension() const {
+		return this->dimension;
+	}
+
+	int get_code_size() const {
+		return this->subspaces;
+	}
+
+	static void hellinger(const Mat& src, Mat& dst);
+
+private:
+
+	void __set_offsets();
+
+	void __distance_tables(const float* query, Mat& tables) const;
+
+	void __approximate_distances(const Mat& tables, Mat& distances) const;
+
+};
+
+#endif /* PQINDEX_H_ */
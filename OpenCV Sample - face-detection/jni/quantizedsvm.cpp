@@ -0,0 +1,250 @@
+/*
+ * quantizedsvm.cpp
+ */
+
+#include "quantizedsvm.h"
+
+#include <algorithm>
+#include <cmath>
+
+// 32-bit ARM compilers define __ARM_NEON__, AArch64 (and ACLE) ones
+// __ARM_NEON
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define QUANTIZED_NEON 1
+#endif
+
+#if defined(QUANTIZED_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(QUANTIZED_NEON)
+
+static inline int horizontal_sum(int32x4_t acc) {
+#if defined(__aarch64__)
+	return vaddvq_s32(acc);
+#else
+	// vaddvq_s32 is AArch64 only
+	return vgetq_lane_s32(acc, 0) + vgetq_lane_s32(acc, 1) +
+		   vgetq_lane_s32(acc, 2) + vgetq_lane_s32(acc, 3);
+#endif
+}
+
+#endif
+
+#if defined(__SSE2__) && !defined(QUANTIZED_NEON)
+
+// int8 lanes sign-extended to int16
+static inline __m128i widen_low(__m128i v) {
+	return _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+}
+
+static inline __m128i widen_high(__m128i v) {
+	return _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+}
+
+static inline int horizontal_sum(__m128i acc) {
+	int lanes[4];
+	_mm_storeu_si128((__m128i*) lanes, acc);
+	return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+#endif
+
+// Differences of int8 values fit int16 and a pair of squared differences
+// fits int32, so both loops are exact.
+int squared_distance_s8(const schar* a, const schar* b, int n) {
+	int i = 0;
+	int result = 0;
+#if defined(QUANTIZED_NEON)
+	int32x4_t acc = vdupq_n_s32(0);
+	for(; i <= n - 16; i += 16) {
+		int8x16_t va = vld1q_s8(a + i);
+		int8x16_t vb = vld1q_s8(b + i);
+		int16x8_t lo = vsubl_s8(vget_low_s8(va), vget_low_s8(vb));
+		int16x8_t hi = vsubl_s8(vget_high_s8(va), vget_high_s8(vb));
+		acc = vmlal_s16(acc, vget_low_s16(lo), vget_low_s16(lo));
+		acc = vmlal_s16(acc, vget_high_s16(lo), vget_high_s16(lo));
+		acc = vmlal_s16(acc, vget_low_s16(hi), vget_low_s16(hi));
+		acc = vmlal_s16(acc, vget_high_s16(hi), vget_high_s16(hi));
+	}
+	result = horizontal_sum(acc);
+#elif defined(__SSE2__)
+	__m128i acc = _mm_setzero_si128();
+	for(; i <= n - 16; i += 16) {
+		__m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+		__m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+		__m128i lo = _mm_sub_epi16(widen_low(va), widen_low(vb));
+		__m128i hi = _mm_sub_epi16(widen_high(va), widen_high(vb));
+		acc = _mm_add_epi32(acc, _mm_madd_epi16(lo, lo));
+		acc = _mm_add_epi32(acc, _mm_madd_epi16(hi, hi));
+	}
+	result = horizontal_sum(acc);
+#endif
+	for(; i < n; i++) {
+		int d = a[i] - b[i];
+		result += d*d;
+	}
+	return result;
+}
+
+int dot_product_s8(const schar* a, const schar* b, int n) {
+	int i = 0;
+	int result = 0;
+#if defined(__ARM_FEATURE_DOTPROD)
+	int32x4_t acc = vdupq_n_s32(0);
+	for(; i <= n - 16; i += 16) {
+		acc = vdotq_s32(acc, vld1q_s8(a + i), vld1q_s8(b + i));
+	}
+	result = horizontal_sum(acc);
+#elif defined(QUANTIZED_NEON)
+	int32x4_t acc = vdupq_n_s32(0);
+	for(; i <= n - 16; i += 16) {
+		int8x16_t va = vld1q_s8(a + i);
+		int8x16_t vb = vld1q_s8(b + i);
+		acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+		acc = vpadalq_s16(acc, vmull_s8(vget_high_s8(va), vget_high_s8(vb)));
+	}
+	result = horizontal_sum(acc);
+#elif defined(__SSE2__)
+	__m128i acc = _mm_setzero_si128();
+	for(; i <= n - 16; i += 16) {
+		__m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+		__m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+		acc = _mm_add_epi32(acc, _mm_madd_epi16(widen_low(va), widen_low(vb)));
+		acc = _mm_add_epi32(acc, _mm_madd_epi16(widen_high(va), widen_high(vb)));
+	}
+	result = horizontal_sum(acc);
+#endif
+	for(; i < n; i++) {
+		result += a[i]*b[i];
+	}
+	return result;
+}
+
+static inline schar quantize_value(double v) {
+	return (schar) max(-127, min(127, cvRound(v)));
+}
+
+QuantizedSvm::QuantizedSvm() {
+
+	this->var_count = 0;
+	this->sv_count = 0;
+	this->class_labels[0] = -1;
+	this->class_labels[1] = 1;
+	this->rho = 0.0f;
+	this->padded = 0;
+	this->lut_scale = 0.0f;
+
+}
+
+QuantizedSvm::~QuantizedSvm() {
+}
+
+void QuantizedSvm::quantize(const SvmModel& model, const Mat& mean, const Mat& deviation) {
+
+	if (model.kernel_type != CvSVM::RBF)
+		CV_Error(CV_StsBadArg, "Only RBF models are quantized");
+	if (mean.cols != model.var_count || deviation.cols != model.var_count)
+		CV_Error(CV_StsBadArg, "mean and std do not match the model");
+
+	this->var_count = model.var_count;
+	this->sv_count = model.sv_count;
+	this->class_labels[0] = model.class_labels[0];
+	this->class_labels[1] = model.class_labels[1];
+	this->rho = (float) model.rho;
+	this->padded = (model.var_count + 15) & ~15;
+
+	double step = QUANT_RANGE/127.0;
+
+	this->vectors = Mat::zeros(this->sv_count, this->padded, CV_8SC1);
+	this->norms.create(1, this->sv_count, CV_32SC1);
+	model.alpha.convertTo(this->alpha, CV_32F);
+
+	for (int i = 0; i < this->sv_count; i++) {
+		const float* sv = model.support_vectors.ptr<float>(i);
+		schar* q = this->vectors.ptr<schar>(i);
+		for (int k = 0; k < this->var_count; k++) {
+			q[k] = quantize_value(sv[k]/step);
+		}
+		this->norms.at<int>(i) = dot_product_s8(q, q, this->padded);
+	}
+
+	mean.convertTo(this->mean, CV_32F);
+	deviation.convertTo(this->deviation, CV_32F);
+	this->inverse_scale.create(1, this->var_count, CV_32FC1);
+	for (int k = 0; k < this->var_count; k++) {
+		this->inverse_scale.at<float>(k) = (float)(1.0/(step*this->deviation.at<float>(k)));
+	}
+
+	// exp(-gamma step^2 D) sampled over D in [0, QUANT_LUT_EXTENT/(gamma step^2)]
+	double g = model.gamma*step*step;
+	this->lut_scale = (float)(QUANT_LUT_SIZE*g/QUANT_LUT_EXTENT);
+	this->lut.create(1, QUANT_LUT_SIZE + 1, CV_32FC1);
+	for (int k = 0; k <= QUANT_LUT_SIZE; k++) {
+		this->lut.at<float>(k) = (float) exp(-QUANT_LUT_EXTENT*k/QUANT_LUT_SIZE);
+	}
+
+	this->window = Mat::zeros(1, this->padded, CV_8SC1);
+}
+
+void QuantizedSvm::quantize_window(const float* x, schar* q) const {
+
+	const float* mean = this->mean.ptr<float>(0);
+	const float* inverse = this->inverse_scale.ptr<float>(0);
+
+	for (int k = 0; k < this->var_count; k++) {
+		q[k] = quantize_value((x[k] - mean[k])*inverse[k]);
+	}
+}
+
+float QuantizedSvm::decision(const float* x) const {
+
+	schar* q = this->window.ptr<schar>(0);
+	this->quantize_window(x, q);
+
+	const float* a = this->alpha.ptr<float>(0);
+	const float* lut = this->lut.ptr<float>(0);
+	float sum = -this->rho;
+
+#if defined(__ARM_FEATURE_DOTPROD)
+	// |x - sv|^2 = |x|^2 + |sv|^2 - 2 x.sv, with the dot products on sdot
+	int window_norm = dot_product_s8(q, q, this->padded);
+	const int* norms = this->norms.ptr<int>(0);
+#endif
+
+	for (int i = 0; i < this->sv_count; i++) {
+		const schar* sv = this->vectors.ptr<schar>(i);
+#if defined(__ARM_FEATURE_DOTPROD)
+		int D = window_norm + norms[i] - 2*dot_product_s8(q, sv, this->padded);
+#else
+		int D = squared_distance_s8(q, sv, this->padded);
+#endif
+		float t = D*this->lut_scale;
+		if (t >= QUANT_LUT_SIZE)
+			continue;
+
+		int k = (int) t;
+		float kernel = lut[k] + (t - k)*(lut[k + 1] - lut[k]);
+		sum += a[i]*kernel;
+	}
+
+	return sum;
+}
+
+double QuantizedSvm::flip_rate(const SvmModel& model, const Mat& samples) const {
+
+	if (samples.rows == 0)
+		return 0.0;
+
+	Mat normalized = samples.clone();
+	normalize_features(normalized, this->mean, this->deviation);
+
+	int flips = 0;
+	for (int i = 0; i < samples.rows; i++) {
+		flips += (this->predict(samples.ptr<float>(i)) != model.predict(normalized.ptr<float>(i)));
+	}
+
+	return (double)flips/samples.rows;
+}
@@ -0,0 +1,93 @@
+/*
+ * quantizedsvm.h
+ */
+
+#ifndef QUANTIZEDSVM_H_
+#define QUANTIZEDSVM_H_
+
+#include <opencv2/core/core.hpp>
+
+#include <string>
+
+#include "svmmodel.h"
+
+// normalised values in [-QUANT_RANGE, QUANT_RANGE] standard deviations map
+// to [-127, 127]
+#define QUANT_RANGE 4.0
+#define QUANT_LUT_SIZE 1024
+// the kernel is taken as 0 past exp(-QUANT_LUT_EXTENT)
+#define QUANT_LUT_EXTENT 16.0
+
+using namespace cv;
+using namespace std;
+
+// Int8 evaluation of an RBF SvmModel.
+//
+// mean.txt and std.txt put every dimension on the same footing, so one
+// step, QUANT_RANGE/127 standard deviations, quantizes all of them: the
+// support vectors, already normalised, are scaled by 127/QUANT_RANGE and
+// a raw window by 127/(QUANT_RANGE std_d) after subtracting mean_d. The
+// squared distance is then an exact integer sum of int8 differences, and
+// exp(-gamma step^2 D) is read from a table with linear interpolation.
+//
+// Support vectors take a quarter of the float memory, rows padded to 16
+// bytes for the SIMD loops.
+class QuantizedSvm {
+
+public:
+	int var_count;
+	int sv_count;
+	int class_labels[2];
+	float rho;
+
+private:
+	int padded;
+	Mat vectors;		// sv_count x padded, CV_8SC1
+	Mat norms;			// |sv|^2, CV_32SC1
+	Mat alpha;			// CV_32FC1
+	Mat mean;
+	Mat deviation;
+	Mat inverse_scale;	// 127/(QUANT_RANGE std_d)
+	Mat lut;
+	float lut_scale;
+
+	mutable Mat window;
+
+public:
+	QuantizedSvm();
+
+	virtual ~QuantizedSvm();
+
+	void quantize(const SvmModel& model, const Mat& mean, const Mat& deviation);
+
+	bool empty() const {
+		return this->sv_count == 0;
+	}
+
+	size_t memory() const {
+		return this->vectors.total()*this->vectors.elemSize();
+	}
+
+	void quantize_window(const float* x, schar* q) const;
+
+	float decision(const float* x) const;
+
+	float face_score(const float* x) const {
+		return this->class_labels[0] == 1 ? this->decision(x) : -this->decision(x);
+	}
+
+	float predict(const float* x) const {
+		return (float) this->class_labels[this->decision(x) > 0 ? 0 : 1];
+	}
+
+	double flip_rate(const SvmModel& model, const Mat& samples) const;
+
+};
+
+// sum (a_i - b_i)^2 over n int8 values, n a multiple of 16
+int squared_distance_s8(const schar* a, const schar* b, int n);
+
+// sum a_i b_i over n int8 values, n a multiple of 16
+int dot_product_s8(const schar* a, const schar* b, int n);
+
+#endif /* QUANTIZEDSVM_H_ */
@@ -0,0 +1,212 @@
+/*
+ * rbfevaluator.cpp
+ */
+
+#include "rbfevaluator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+static double squared_distance(const float* a, const float* b, int n) {
+
+	double s = 0.0;
+	for (int k = 0; k < n; k++) {
+		double t = (double)a[k] - b[k];
+		s += t*t;
+	}
+	return s;
+}
+
+RbfEvaluator::RbfEvaluator() {
+
+	this->margin = 0.0;
+	this->windows = 0;
+	this->evaluated = 0;
+
+}
+
+RbfEvaluator::RbfEvaluator(const SvmModel& model, int clusters) {
+
+	this->margin = 0.0;
+	this->windows = 0;
+	this->evaluated = 0;
+
+	this->set_model(model, clusters);
+
+}
+
+RbfEvaluator::RbfEvaluator(const RbfEvaluator& other) {
+	*this = other;
+}
+
+RbfEvaluator::~RbfEvaluator() {
+}
+
+RbfEvaluator& RbfEvaluator::operator=(const RbfEvaluator& other) {
+
+	this->model = other.model;
+	this->order = other.order;
+	this->sorted_vectors = other.sorted_vectors;
+	this->sorted_alpha = other.sorted_alpha;
+	this->sorted_cluster = other.sorted_cluster;
+	this->centers = other.centers;
+	this->radius = other.radius;
+	this->positive = other.positive;
+	this->negative = other.negative;
+	this->margin = other.margin;
+
+	// the tables are shared, the scratch rows are not: copies of the
+	// models' evaluator may score windows at the same time
+	this->kernels = other.kernels.empty() ? Mat() : Mat(other.kernels.size(), other.kernels.type());
+	this->cluster_bound = other.cluster_bound.empty() ? Mat() :
+						  Mat(other.cluster_bound.size(), other.cluster_bound.type());
+	this->reset_statistics();
+
+	return *this;
+}
+
+void RbfEvaluator::set_model(const SvmModel& model, int clusters) {
+
+	if (model.kernel_type != CvSVM::RBF)
+		CV_Error(CV_StsBadArg, "Early exit needs an RBF model, its kernel values are bounded by 1");
+
+	this->model = model;
+
+	int n = model.sv_count;
+	int d = model.var_count;
+	const double* a = model.alpha.ptr<double>(0);
+
+	vector< pair<double, int> > magnitude(n);
+	for (int i = 0; i < n; i++) {
+		magnitude[i] = make_pair(-fabs(a[i]), i);
+	}
+	sort(magnitude.begin(), magnitude.end());
+
+	this->order.create(1, n, CV_32SC1);
+	this->sorted_vectors.create(n, d, CV_32FC1);
+	this->sorted_alpha.create(1, n, CV_64FC1);
+
+	double total = fabs(model.rho);
+	for (int j = 0; j < n; j++) {
+		int i = magnitude[j].second;
+		this->order.at<int>(j) = i;
+		model.support_vectors.row(i).copyTo(this->sorted_vectors.row(j));
+		this->sorted_alpha.at<double>(j) = a[i];
+		total += fabs(a[i]);
+	}
+
+	// far above the rounding of a few hundred double products
+	this->margin = 1e-9*total;
+
+	this->sorted_cluster = Mat::zeros(1, n, CV_32SC1);
+	this->centers.release();
+	this->radius.release();
+
+	clusters = min(clusters, n);
+	if (clusters > 1) {
+		Mat labels;
+		kmeans(this->sorted_vectors, clusters, labels,
+			   TermCriteria(TermCriteria::COUNT + TermCriteria::EPS, 50, 1e-4),
+			   3, KMEANS_PP_CENTERS, this->centers);
+
+		this->radius = Mat::zeros(1, clusters, CV_64FC1);
+		for (int j = 0; j < n; j++) {
+			int c = labels.at<int>(j);
+			this->sorted_cluster.at<int>(j) = c;
+			double r = sqrt(squared_distance(this->sorted_vectors.ptr<float>(j),
+											 this->centers.ptr<float>(c), d));
+			this->radius.at<double>(c) = max(this->radius.at<double>(c), r);
+		}
+
+		// a little slack so that a vector on the rim is never bounded below
+		// its own kernel value
+		for (int c = 0; c < clusters; c++) {
+			this->radius.at<double>(c) = this->radius.at<double>(c)*(1.0 + 1e-6) + 1e-6;
+		}
+	}
+
+	// alpha mass each cluster can add in either direction
+	this->positive = Mat::zeros(1, max(clusters, 1), CV_64FC1);
+	this->negative = Mat::zeros(1, max(clusters, 1), CV_64FC1);
+	for (int j = 0; j < n; j++) {
+		double aj = this->sorted_alpha.at<double>(j);
+		int c = this->sorted_cluster.at<int>(j);
+		if (aj > 0)
+			this->positive.at<double>(c) += aj;
+		else
+			this->negative.at<double>(c) += aj;
+	}
+
+	this->kernels.create(1, n, CV_64FC1);
+	this->cluster_bound.create(1, max(clusters, 1), CV_64FC1);
+	this->reset_statistics();
+}
+
+double RbfEvaluator::bounded_decision(const float* x, double cut) const {
+
+	int n = this->model.sv_count;
+	int d = this->model.var_count;
+	const int* order = this->order.ptr<int>(0);
+	const double* a = this->sorted_alpha.ptr<double>(0);
+	const int* cluster = this->sorted_cluster.ptr<int>(0);
+	double* k = this->kernels.ptr<double>(0);
+	double* bound = this->cluster_bound.ptr<double>(0);
+
+	// largest kernel value each cluster can still give
+	if (this->centers.empty()) {
+		bound[0] = 1.0;
+	} else {
+		for (int c = 0; c < this->centers.rows; c++) {
+			double t = sqrt(squared_distance(x, this->centers.ptr<float>(c), d)) - this->radius.at<double>(c);
+			bound[c] = t > 0 ? exp(-this->model.gamma*t*t) : 1.0;
+		}
+	}
+
+	// the decision lies in [partial + lower, partial + upper]
+	double partial = -this->model.rho;
+	double upper = 0.0;
+	double lower = 0.0;
+	for (int c = 0; c < this->cluster_bound.cols; c++) {
+		upper += bound[c]*this->positive.at<double>(c);
+		lower += bound[c]*this->negative.at<double>(c);
+	}
+
+	this->windows++;
+
+	for (int j = 0; j < n; j++) {
+
+		if (partial + lower > cut + this->margin) {
+			this->evaluated += j;
+			return partial + lower;
+		}
+		if (partial + upper < cut - this->margin) {
+			this->evaluated += j;
+			return partial + upper;
+		}
+
+		double kj = this->model.kernel(x, this->sorted_vectors.ptr<float>(j));
+		k[order[j]] = kj;
+		partial += a[j]*kj;
+
+		if (a[j] > 0)
+			upper -= bound[cluster[j]]*a[j];
+		else
+			lower -= bound[cluster[j]]*a[j];
+	}
+
+	this->evaluated += n;
+
+	// too close to call early: sum the same kernel values in the model's
+	// order, exactly as SvmModel::decision does
+	const double* alpha = this->model.alpha.ptr<double>(0);
+	double sum = -this->model.rho;
+	for (int i = 0; i < n; i++) {
+		sum += alpha[i]*k[i];
+	}
+
+	return sum;
+}
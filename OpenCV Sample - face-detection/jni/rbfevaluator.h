@@ -0,0 +1,103 @@
+/*
+ * rbfevaluator.h
+ */
+
+#ifndef RBFEVALUATOR_H_
+#define RBFEVALUATOR_H_
+
+#include <opencv2/core/core.hpp>
+
+#include "svmmodel.h"
+
+// support vector clusters used to bound the kernel values still to come
+#define RBF_DEFAULT_CLUSTERS 16
+
+using namespace cv;
+
+// Early-exit evaluation of an RBF SvmModel.
+//
+// Every kernel value lies in (0, 1], so after some support vectors the
+// decision is bracketed by the partial sum plus the leftover negative
+// alphas and the partial sum plus the leftover positive alphas. Support
+// vectors are visited by decreasing |alpha| and the evaluation stops as
+// soon as the bracket no longer contains the cut, zero for a plain
+// decision or the detector's score threshold. With clusters, the support
+// vectors are grouped by k-means beforehand; the distance from the window
+// to a cluster centre minus the cluster radius bounds the distance to all
+// of its vectors, so the leftover alphas of a far cluster count for less.
+//
+// The bracket is widened by a margin well above the rounding error, and
+// when it never excludes the cut the decision is summed in the model's own
+// order from the same kernel values, so decisions are identical to
+// SvmModel::predict and to comparing SvmModel::face_score to the cut.
+class RbfEvaluator {
+
+private:
+	SvmModel model;
+	Mat order;
+	Mat sorted_vectors;
+	Mat sorted_alpha;
+	Mat sorted_cluster;
+	Mat centers;
+	Mat radius;
+	Mat positive;
+	Mat negative;
+	double margin;
+
+	mutable Mat kernels;
+	mutable Mat cluster_bound;
+	mutable int64 windows;
+	mutable int64 evaluated;
+
+public:
+	RbfEvaluator();
+
+	RbfEvaluator(const SvmModel& model, int clusters = RBF_DEFAULT_CLUSTERS);
+
+	RbfEvaluator(const RbfEvaluator& other);
+
+	virtual ~RbfEvaluator();
+
+	RbfEvaluator& operator=(const RbfEvaluator& other);
+
+	void set_model(const SvmModel& model, int clusters = RBF_DEFAULT_CLUSTERS);
+
+	bool empty() const {
+		return this->model.empty();
+	}
+
+	const SvmModel& get_model() const {
+		return this->model;
+	}
+
+	// The decision if it had to be summed, else the bound that put it on
+	// one side of cut: either way above cut exactly when the decision is.
+	double bounded_decision(const float* x, double cut) const;
+
+	bool positive_decision(const float* x) const {
+		return this->bounded_decision(x, 0.0) > 0;
+	}
+
+	float predict(const float* x) const {
+		return (float) this->model.class_labels[this->positive_decision(x) ? 0 : 1];
+	}
+
+	// Above threshold exactly when SvmModel::face_score is; only the
+	// windows close to it get their actual score.
+	double face_score(const float* x, double threshold) const {
+		double sign = this->model.face_sign();
+		return sign*this->bounded_decision(x, sign*threshold);
+	}
+
+	double mean_kernel_evaluations() const {
+		return this->windows > 0 ? (double)this->evaluated/this->windows : 0.0;
+	}
+
+	void reset_statistics() const {
+		this->windows = 0;
+		this->evaluated = 0;
+	}
+
+};
+
+#endif /* RBFEVALUATOR_H_ */
@@ -0,0 +1,166 @@
+/*
+ * reducedset.cpp
+ */
+
+#include "reducedset.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// keeps K_zz invertible when two reduced vectors end up together
+#define REDUCED_SET_RIDGE 1e-8
+
+static void kernel_matrix(const SvmModel& model, const Mat& a, const Mat& b, Mat& K) {
+
+	K.create(a.rows, b.rows, CV_64FC1);
+	for (int i = 0; i < a.rows; i++) {
+		double* k = K.ptr<double>(i);
+		for (int j = 0; j < b.rows; j++) {
+			k[j] = model.kernel(a.ptr<float>(i), b.ptr<float>(j));
+		}
+	}
+}
+
+// |sum_i a_i phi(x_i) - sum_j b_j phi(z_j)|^2
+static double squared_distance(const SvmModel& model, const Mat& x, const Mat& a,
+							   const Mat& z, const Mat& b, double aa) {
+
+	Mat Kzx, Kzz;
+	kernel_matrix(model, z, x, Kzx);
+	kernel_matrix(model, z, z, Kzz);
+
+	double ab = Mat(b*Kzx*a.t()).at<double>(0);
+	double bb = Mat(b*Kzz*b.t()).at<double>(0);
+
+	return aa - 2.0*ab + bb;
+}
+
+static void solve_betas(const SvmModel& model, const Mat& z, Mat& beta) {
+
+	Mat Kzs, Kzz;
+	kernel_matrix(model, z, model.support_vectors, Kzs);
+	kernel_matrix(model, z, z, Kzz);
+
+	Kzz += Mat::eye(Kzz.size(), CV_64F)*REDUCED_SET_RIDGE;
+
+	Mat rhs = Kzs*model.alpha.t();
+	Mat column;
+	solve(Kzz, rhs, column, DECOMP_SVD);
+	beta = column.t();
+}
+
+void reduce_support_vectors(const SvmModel& model, int count, SvmModel& reduced, int iterations) {
+
+	if (model.kernel_type != CvSVM::RBF)
+		CV_Error(CV_StsBadArg, "Only RBF models are reduced");
+	if (count <= 0)
+		CV_Error(CV_StsBadArg, "The reduced model needs at least one vector");
+
+	reduced = model;
+	if (count >= model.sv_count) {
+		reduced.support_vectors = model.support_vectors.clone();
+		reduced.alpha = model.alpha.clone();
+		return;
+	}
+
+	const Mat& sv = model.support_vectors;
+	const double* alpha = model.alpha.ptr<double>(0);
+	int d = model.var_count;
+
+	Mat Kss;
+	kernel_matrix(model, sv, sv, Kss);
+	double ww = Mat(model.alpha*Kss*model.alpha.t()).at<double>(0);
+
+	Mat labels, z;
+	kmeans(sv, count, labels, TermCriteria(TermCriteria::COUNT + TermCriteria::EPS, 100, 1e-5),
+		   3, KMEANS_PP_CENTERS, z);
+
+	Mat beta;
+	solve_betas(model, z, beta);
+	double error = squared_distance(model, sv, model.alpha, z, beta, ww);
+
+	vector<double> numerator(d);
+
+	for (int it = 0; it < iterations; it++) {
+
+		Mat candidate = z.clone();
+		const double* b = beta.ptr<double>(0);
+
+		for (int j = 0; j < count; j++) {
+
+			float* zj = candidate.ptr<float>(j);
+			double denominator = 0.0;
+			fill(numerator.begin(), numerator.end(), 0.0);
+
+			// the support vectors pull with alpha, the other reduced vectors
+			// push with their betas
+			for (int i = 0; i < sv.rows; i++) {
+				const float* p = sv.ptr<float>(i);
+				double c = alpha[i]*model.kernel(zj, p);
+				denominator += c;
+				for (int k = 0; k < d; k++) {
+					numerator[k] += c*p[k];
+				}
+			}
+			for (int l = 0; l < count; l++) {
+				if (l == j)
+					continue;
+				const float* p = candidate.ptr<float>(l);
+				double c = -b[l]*model.kernel(zj, p);
+				denominator += c;
+				for (int k = 0; k < d; k++) {
+					numerator[k] += c*p[k];
+				}
+			}
+
+			if (fabs(denominator) < 1e-12)
+				continue;
+
+			for (int k = 0; k < d; k++) {
+				zj[k] = (float)(numerator[k]/denominator);
+			}
+		}
+
+		Mat candidate_beta;
+		solve_betas(model, candidate, candidate_beta);
+		double candidate_error = squared_distance(model, sv, model.alpha, candidate, candidate_beta, ww);
+
+		if (candidate_error >= error)
+			break;
+
+		z = candidate;
+		beta = candidate_beta;
+		error = candidate_error;
+	}
+
+	reduced.sv_count = count;
+	reduced.support_vectors = z;
+	reduced.alpha = beta;
+}
+
+double reduction_error(const SvmModel& model, const SvmModel& reduced) {
+
+	Mat Kss;
+	kernel_matrix(model, model.support_vectors, model.support_vectors, Kss);
+	double ww = Mat(model.alpha*Kss*model.alpha.t()).at<double>(0);
+
+	if (ww <= 0)
+		return 0.0;
+
+	return squared_distance(model, model.support_vectors, model.alpha,
+							reduced.support_vectors, reduced.alpha, ww)/ww;
+}
+
+double decision_agreement(const SvmModel& a, const SvmModel& b, const Mat& samples) {
+
+	if (samples.rows == 0)
+		return 1.0;
+
+	int agree = 0;
+	for (int i = 0; i < samples.rows; i++) {
+		agree += (a.predict(samples.ptr<float>(i)) == b.predict(samples.ptr<float>(i)));
+	}
+
+	return (double)agree/samples.rows;
+}
@@ -0,0 +1,40 @@
+/*
+ * reducedset.h
+ */
+
+#ifndef REDUCEDSET_H_
+#define REDUCEDSET_H_
+
+#include <opencv2/core/core.hpp>
+
+#include "svmmodel.h"
+
+// fixed-point sweeps over the reduced vectors
+#define REDUCED_SET_ITERATIONS 10
+
+using namespace cv;
+
+// Reduced-set compression of an RBF SvmModel (Burges; Schoelkopf et al.).
+//
+// The decision function is w . phi(x) - rho with w = sum_i alpha_i phi(sv_i).
+// The reduced model keeps rho and replaces w by sum_j beta_j phi(z_j) over
+// count synthetic vectors:
+//
+// - the z_j start as k-means centres of the support vectors;
+// - for fixed z the betas minimising |w - w'|^2 solve K_zz beta = K_zs alpha;
+// - every sweep moves each z_j by the RBF pre-image fixed point
+//   z = sum_p c_p K(z, p) p / sum_p c_p K(z, p) towards what the other
+//   vectors leave unexplained, then re-solves the betas. A sweep that does
+//   not lower |w - w'|^2 is undone and the search stops.
+//
+// The result is an ordinary SvmModel, save() writes it for CvSVM::load.
+void reduce_support_vectors(const SvmModel& model, int count, SvmModel& reduced,
+							int iterations = REDUCED_SET_ITERATIONS);
+
+// |w - w'|^2/|w|^2 between a model and its reduction.
+double reduction_error(const SvmModel& model, const SvmModel& reduced);
+
+// Fraction of samples, already normalised, on which the two models agree.
+double decision_agreement(const SvmModel& a, const SvmModel& b, const Mat& samples);
+
+#endif /* REDUCEDSET_H_ */
@@ -0,0 +1,104 @@
+/*
+ * scanparameters.cpp
+ */
+
+#include "scanparameters.h"
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <cmath>
+#include <sstream>
+
+using namespace std;
+
+ScanParameters::ScanParameters() {
+
+	this->stride = STRIDE;
+	this->box_size = BOX_SIZE;
+	this->cell_size = DEFAULT_CELLSIZE;
+	this->downscale = DEFAULT_DOWNSCALE;
+	this->blur_size = DEFAULT_BLUR_SIZE;
+	this->pyramid_scale = DEFAULT_PYRAMID_SCALE;
+	this->pyramid_levels = DEFAULT_PYRAMID_LEVELS;
+	this->min_face_size = 0;
+	this->max_face_size = 0;
+	this->score_threshold = 0.0;
+	this->descriptor_mode = DESCRIPTOR_VLFEAT;
+
+}
+
+double ScanParameters::level_scale(int level) const {
+	return this->downscale*pow(this->pyramid_scale, level);
+}
+
+void ScanParameters::scanned_levels(cv::Size frame, vector<int>& levels) const {
+
+	levels.clear();
+
+	for (int l = 0; l < this->pyramid_levels; l++) {
+
+		double scale = this->level_scale(l);
+		if (cvRound(frame.width*scale) <= this->box_size || cvRound(frame.height*scale) <= this->box_size)
+			break;
+
+		// the coarsest level also takes every larger face
+		double smallest = this->level_face_size(l);
+		bool last = (l + 1 == this->pyramid_levels);
+		double largest = last ? HUGE_VAL : this->level_face_size(l + 1);
+
+		if (largest <= this->min_face_size)
+			continue;
+		if (this->max_face_size > 0 && smallest > this->max_face_size)
+			break;
+
+		levels.push_back(l);
+	}
+}
+
+void ScanParameters::build_level(const cv::Mat& frame, int level, cv::Mat& blurred, cv::Mat& out) const {
+
+	double scale = this->level_scale(level);
+	cv::Size size(cvRound(frame.cols*scale), cvRound(frame.rows*scale));
+
+	// the models were trained on descriptors of frames blurred before the
+	// downscale, with the default interpolation
+	if (this->blur_size > 1) {
+		cv::GaussianBlur(frame, blurred, cv::Size(this->blur_size, this->blur_size), 1.5);
+		cv::resize(blurred, out, size);
+	} else {
+		cv::resize(frame, out, size);
+	}
+}
+
+void ScanParameters::validate(int model_dimension) const {
+
+	if (this->stride <= 0)
+		CV_Error(CV_StsBadArg, "stride must be positive");
+	if (this->box_size <= 0 || this->cell_size <= 0 || this->box_size % this->cell_size != 0)
+		CV_Error(CV_StsBadArg, "box size must be a positive multiple of the cell size");
+	if (!(this->downscale > 0.0 && this->downscale <= 1.0))
+		CV_Error(CV_StsBadArg, "downscale must be in (0, 1]");
+	if (this->blur_size < 0 || (this->blur_size > 0 && this->blur_size % 2 == 0))
+		CV_Error(CV_StsBadArg, "blur size must be 0 or odd");
+	if (!(this->pyramid_scale > 0.0 && this->pyramid_scale < 1.0))
+		CV_Error(CV_StsBadArg, "pyramid scale must be in (0, 1)");
+	if (this->pyramid_levels < 1 || this->pyramid_levels > MAX_PYRAMID_LEVELS)
+		CV_Error(CV_StsBadArg, "pyramid levels out of range");
+	if (this->min_face_size < 0 || this->max_face_size < 0 ||
+			(this->max_face_size > 0 && this->max_face_size < this->min_face_size))
+		CV_Error(CV_StsBadArg, "face sizes must satisfy 0 <= min <= max");
+	if (this->descriptor_mode != DESCRIPTOR_VLFEAT && this->descriptor_mode != DESCRIPTOR_INTEGRAL &&
+			this->descriptor_mode != DESCRIPTOR_SLIDING)
+		CV_Error(CV_StsBadArg, "unknown descriptor mode");
+	// the integral histogram's 16-bit counts are exact up to 65535 pixels
+	if (this->descriptor_mode == DESCRIPTOR_INTEGRAL && this->cell_size*this->cell_size > 65535)
+		CV_Error(CV_StsBadArg, "cells of the integral histogram must hold fewer than 65536 pixels");
+
+	if (model_dimension > 0 && this->descriptor_dimension() != model_dimension) {
+		ostringstream message;
+		message << "box " << this->box_size << " / cell " << this->cell_size << " gives "
+				<< this->descriptor_dimension() << " features, the model takes " << model_dimension;
+		CV_Error(CV_StsBadArg, message.str());
+	}
+}
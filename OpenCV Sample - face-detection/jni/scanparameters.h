@@ -0,0 +1,85 @@
+/*
+ * scanparameters.h
+ */
+
+#ifndef SCANPARAMETERS_H_
+#define SCANPARAMETERS_H_
+
+#include <opencv2/core/core.hpp>
+
+#include <vector>
+
+#define STRIDE 16
+#define BOX_SIZE 64
+#define DEFAULT_CELLSIZE 64
+
+// what nativeMyDetector did before the parameters could be set: blur with
+// a 3x3 Gaussian and scan one level at half the camera resolution
+#define DEFAULT_DOWNSCALE 0.5
+#define DEFAULT_BLUR_SIZE 3
+#define DEFAULT_PYRAMID_SCALE 0.8
+#define DEFAULT_PYRAMID_LEVELS 1
+#define MAX_PYRAMID_LEVELS 8
+
+// how window descriptors are computed while scanning; the integral and
+// sliding histograms count hard-binned cells, not the bilinear cells of
+// vl_lbp_process, and need models retrained on their own descriptors (see
+// tools/dump_features.cpp)
+#define DESCRIPTOR_VLFEAT 0		// vl_lbp_process on every window
+#define DESCRIPTOR_INTEGRAL 1	// lookups in a per-image integral histogram
+#define DESCRIPTOR_SLIDING 2	// running cell histograms updated along each row
+
+// The scan geometry, settable at run time (DetectionBasedTracker.
+// setScanParameters). Level 0 of the pyramid is the camera frame scaled by
+// downscale, every further level by pyramid_scale again; a window of
+// box_size pixels at level l covers box_size/(downscale*pyramid_scale^l)
+// camera pixels. Face sizes are in camera pixels, 0 for no bound. Windows
+// are faces when the model's face score is above score_threshold, and
+// their descriptors are computed as descriptor_mode says.
+struct ScanParameters {
+
+	int stride;
+	int box_size;
+	int cell_size;
+	double downscale;
+	int blur_size;
+	double pyramid_scale;
+	int pyramid_levels;
+	int min_face_size;
+	int max_face_size;
+	double score_threshold;
+	int descriptor_mode;
+
+	ScanParameters();
+
+	// LBP descriptor length of a window, 58 bins per cell
+	int descriptor_dimension() const {
+		return 58*(this->box_size/this->cell_size)*(this->box_size/this->cell_size);
+	}
+
+	double level_scale(int level) const;
+
+	// camera pixels a window covers at a level
+	double level_face_size(int level) const {
+		return this->box_size/this->level_scale(level);
+	}
+
+	// The levels worth scanning for a frame. Level l finds faces from
+	// level_face_size(l) up to the next level's size; levels whose range
+	// misses [min_face_size, max_face_size], and levels smaller than a
+	// window, are left out.
+	void scanned_levels(cv::Size frame, std::vector<int>& levels) const;
+
+	// A level of a camera frame, built as nativeMyDetector always did: the
+	// frame blurred at camera resolution into blurred, which the caller
+	// keeps between frames, then scaled down. frame is only read and may
+	// have padded rows, e.g. the Y plane of an NV21 preview buffer.
+	void build_level(const cv::Mat& frame, int level, cv::Mat& blurred, cv::Mat& out) const;
+
+	// Raises CV_StsBadArg if a value is out of range or, when
+	// model_dimension > 0, if the windows do not give the model's descriptor.
+	void validate(int model_dimension) const;
+
+};
+
+#endif /* SCANPARAMETERS_H_ */
@@ -0,0 +1,146 @@
+/*
+ * slidinghistogram.cpp
+ */
+
+#include "slidinghistogram.h"
+
+#include <cstring>
+
+SlidingHistogram::SlidingHistogram() {
+
+	this->box_size = 0;
+	this->cellsize = 0;
+	this->cwidth = 0;
+	this->x = 0;
+	this->y = 0;
+	this->positioned = false;
+	this->m_lbp_model = vl_lbp_new(VlLbpUniform, false);
+
+}
+
+SlidingHistogram::~SlidingHistogram() {
+	vl_lbp_delete(this->m_lbp_model);
+}
+
+void SlidingHistogram::set_image(const Mat& image) {
+
+	CV_Assert(image.type() == CV_8UC1);
+
+	this->bins.create(image.size(), CV_8UC1);
+	vl_lbp_process_bins(this->m_lbp_model, this->bins.ptr<vl_uint8>(0),
+						image.ptr<vl_uint8>(0), image.cols, image.rows, image.step);
+
+	this->positioned = false;
+}
+
+void SlidingHistogram::set_geometry(int box_size, int cellsize) {
+
+	CV_Assert(cellsize > 0 && box_size >= cellsize);
+
+	this->box_size = box_size;
+	this->cellsize = cellsize;
+	this->cwidth = box_size/cellsize;
+	this->counts.create(this->cwidth*this->cwidth, LBP_BINS, CV_32SC1);
+	this->positioned = false;
+}
+
+void SlidingHistogram::move_to(int x, int y) {
+
+	int dx = x - this->x;
+
+	if (!this->positioned || y != this->y || dx < 0) {
+		this->x = x;
+		this->y = y;
+		this->__recount();
+		return;
+	}
+
+	// whole cells first, then what is left of a cell
+	if (dx >= this->cellsize)
+		this->__shift(dx/this->cellsize);
+	if (dx % this->cellsize > 0)
+		this->__slide(dx % this->cellsize);
+}
+
+void SlidingHistogram::__recount() {
+
+	this->__count_cells(0);
+	this->positioned = true;
+}
+
+void SlidingHistogram::__count_cells(int first) {
+
+	for (int cy = 0; cy < this->cwidth; cy++) {
+		for (int cx = first; cx < this->cwidth; cx++) {
+			memset(this->counts.ptr<int>(cy*this->cwidth + cx), 0, LBP_BINS*sizeof(int));
+		}
+	}
+
+	for (int cy = 0; cy < this->cwidth; cy++) {
+		for (int i = 0; i < this->cellsize; i++) {
+			const uchar* b = this->bins.ptr<uchar>(this->y + cy*this->cellsize + i) + this->x;
+			for (int cx = first; cx < this->cwidth; cx++) {
+				int* hist = this->counts.ptr<int>(cy*this->cwidth + cx);
+				const uchar* cell = b + cx*this->cellsize;
+				for (int j = 0; j < this->cellsize; j++) {
+					if (cell[j] < LBP_BINS)
+						hist[cell[j]]++;
+				}
+			}
+		}
+	}
+}
+
+void SlidingHistogram::__shift(int cells) {
+
+	this->x += cells*this->cellsize;
+
+	if (cells >= this->cwidth) {
+		this->__count_cells(0);
+		return;
+	}
+
+	// the cells still inside the window keep their counts, cells columns
+	// to the left; only the columns that entered on the right are counted
+	for (int cy = 0; cy < this->cwidth; cy++) {
+		memmove(this->counts.ptr<int>(cy*this->cwidth), this->counts.ptr<int>(cy*this->cwidth + cells),
+				(this->cwidth - cells)*LBP_BINS*sizeof(int));
+	}
+	this->__count_cells(this->cwidth - cells);
+}
+
+void SlidingHistogram::__slide(int dx) {
+
+	for (int cy = 0; cy < this->cwidth; cy++) {
+		for (int i = 0; i < this->cellsize; i++) {
+			const uchar* b = this->bins.ptr<uchar>(this->y + cy*this->cellsize + i) + this->x;
+			for (int cx = 0; cx < this->cwidth; cx++) {
+				int* hist = this->counts.ptr<int>(cy*this->cwidth + cx);
+				const uchar* leaving = b + cx*this->cellsize;
+				const uchar* entering = leaving + this->cellsize;
+				for (int j = 0; j < dx; j++) {
+					if (leaving[j] < LBP_BINS)
+						hist[leaving[j]]--;
+					if (entering[j] < LBP_BINS)
+						hist[entering[j]]++;
+				}
+			}
+		}
+	}
+
+	this->x += dx;
+}
+
+void SlidingHistogram::cell_features(float* features) const {
+
+	int cstride = this->cwidth*this->cwidth;
+	unsigned short hist[LBP_BINS];
+
+	for (int c = 0; c < cstride; c++) {
+		const int* counts = this->counts.ptr<int>(c);
+		for (int k = 0; k < LBP_BINS; k++) {
+			hist[k] = (unsigned short)counts[k];
+		}
+		normalize_cell_histogram(hist, features + c, cstride);
+	}
+}
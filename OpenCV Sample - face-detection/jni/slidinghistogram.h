@@ -0,0 +1,73 @@
+/*
+ * slidinghistogram.h
+ */
+
+#ifndef SLIDINGHISTOGRAM_H_
+#define SLIDINGHISTOGRAM_H_
+
+#include <opencv2/core/core.hpp>
+
+#include "integralhistogram.h"
+
+using namespace cv;
+
+// Running cell histograms of one scanning window, in the style of Huang's
+// median filter. When the window moves right along a row by less than a
+// cell, every cell subtracts the columns that left it and adds the columns
+// that entered it, so a step costs O(stride x box height) per column of
+// cells instead of O(box area). A move by whole cells shifts the cell
+// histograms over and only counts the cells that entered; a longer move
+// shifts, then slides the rest. Only a move to another row, or back,
+// recounts the window.
+//
+// The counts are hard-binned and match IntegralHistogram exactly, so both
+// give identical descriptors, and like it this mode needs models retrained
+// on hard-binned descriptors: the shipped ones were trained on the bilinear
+// cells of vl_lbp_process.
+class SlidingHistogram {
+
+private:
+	int box_size;
+	int cellsize;
+	int cwidth;
+	int x;
+	int y;
+	bool positioned;
+	Mat bins;
+	Mat counts;
+	VlLbp* m_lbp_model;
+
+public:
+	SlidingHistogram();
+
+	virtual ~SlidingHistogram();
+
+	void set_image(const Mat& image);
+
+	void set_geometry(int box_size, int cellsize);
+
+	void move_to(int x, int y);
+
+	void cell_features(float* features) const;
+
+	int get_x() const {
+		return this->x;
+	}
+
+	int get_y() const {
+		return this->y;
+	}
+
+private:
+
+	void __recount();
+
+	void __count_cells(int first);
+
+	void __shift(int cells);
+
+	void __slide(int dx);
+
+};
+
+#endif /* SLIDINGHISTOGRAM_H_ */
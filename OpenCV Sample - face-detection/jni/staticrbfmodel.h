@@ -0,0 +1,63 @@
+/*
+ * staticrbfmodel.h
+ */
+
+#ifndef STATICRBFMODEL_H_
+#define STATICRBFMODEL_H_
+
+#include <cmath>
+
+// RBF decision function over a model compiled into the library. Model is
+// the struct a header written by tools/embed_model.cpp defines: the
+// descriptor length and the number of support vectors are enum constants,
+// gamma and rho static const doubles, and the arrays static const, so the
+// loops have constant trip counts the compiler can unroll and vectorise,
+// the constants fold into the code, and nothing is parsed or copied at
+// run time.
+//
+// Raw descriptors go in, normalised with the embedded mean and std. It is
+// a classifier policy (see classifierpolicy.h), faces score above zero.
+template <class Model>
+class StaticRbfModel {
+
+public:
+	int dimension() const {
+		return Model::var_count;
+	}
+
+	// normalised here, with the embedded mean and std
+	bool normalized() const {
+		return false;
+	}
+
+	double decision(const float* x) const {
+
+		float z[Model::var_count];
+		for (int k = 0; k < Model::var_count; k++) {
+			z[k] = (x[k] - Model::mean()[k])/Model::deviation()[k];
+		}
+
+		double sum = -Model::rho();
+		for (int i = 0; i < Model::sv_count; i++) {
+			const float* sv = Model::support_vectors() + i*Model::var_count;
+			double s = 0.0;
+			for (int k = 0; k < Model::var_count; k++) {
+				double t = z[k] - sv[k];
+				s += t*t;
+			}
+			sum += Model::alpha()[i]*exp(-Model::gamma()*s);
+		}
+
+		return sum;
+	}
+
+	void score(const float* descriptors, int n, float* out) {
+		double sign = Model::first_label == 1 ? 1.0 : -1.0;
+		for (int i = 0; i < n; i++) {
+			out[i] = (float)(sign*this->decision(descriptors + i*Model::var_count));
+		}
+	}
+
+};
+
+#endif /* STATICRBFMODEL_H_ */
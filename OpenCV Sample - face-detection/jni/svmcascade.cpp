@@ -0,0 +1,139 @@
+/*
+ * svmcascade.cpp
+ */
+
+#include "svmcascade.h"
+
+#include <android/log.h>
+
+#define LOG_TAG "FaceDetection/SvmCascade"
+#define LOGD(...) ((void)__android_log_print(ANDROID_LOG_DEBUG, LOG_TAG, __VA_ARGS__))
+
+// the uniform mapping never changes, every cascade reads the same one
+static VlLbp* uniform_lbp() {
+	static VlLbp* lbp = vl_lbp_new(VlLbpUniform, false);
+	return lbp;
+}
+
+SvmCascade::SvmCascade() {
+}
+
+SvmCascade::~SvmCascade() {
+}
+
+void SvmCascade::add_stage(string model, string mean, string deviation, int cells, double threshold) {
+
+	CascadeStage stage;
+
+	stage.model.load(model);
+	load_text_vector(mean, stage.mean);
+	load_text_vector(deviation, stage.deviation);
+	stage.cells = cells;
+	stage.threshold = threshold;
+	stage.evaluated = 0;
+	stage.passed = 0;
+
+	if (cells < 1 || stage.model.var_count != cells*cells*(int)vl_lbp_get_dimension(uniform_lbp()) ||
+			stage.mean.cols != stage.model.var_count ||
+			stage.deviation.cols != stage.model.var_count)
+		CV_Error(CV_StsBadArg, "Cascade stage does not match its cell layout");
+
+	this->stages.push_back(stage);
+}
+
+void SvmCascade::load(string filename) {
+
+	FileStorage fs(filename, FileStorage::READ);
+	if (!fs.isOpened())
+		CV_Error(CV_StsError, "Could not open the cascade " + filename);
+
+	string directory;
+	size_t slash = filename.rfind('/');
+	if (slash != string::npos)
+		directory = filename.substr(0, slash + 1);
+
+	FileNode stages = fs["stages"];
+	if (stages.type() != FileNode::SEQ || stages.size() == 0)
+		CV_Error(CV_StsParseError, "No stages in the cascade " + filename);
+
+	this->stages.clear();
+	for (FileNodeIterator it = stages.begin(); it != stages.end(); ++it) {
+		FileNode stage = *it;
+		double threshold = stage["threshold"].empty() ? 0.0 : (double) stage["threshold"];
+
+		this->add_stage(directory + (string) stage["model"], directory + (string) stage["mean"],
+						directory + (string) stage["std"], (int) stage["cells"], threshold);
+	}
+}
+
+void SvmCascade::set_threshold(int stage, double threshold) {
+	this->stages.at(stage).threshold = threshold;
+}
+
+bool SvmCascade::classify(const Mat& image, int x, int y, int box_size, double* score) {
+
+	double face_score = 0.0;
+
+	// the window as vl_lbp_process reads it, once for all the stages
+	this->window.resize(box_size*box_size);
+	for (int i = 0; i < box_size; i++) {
+		const uchar* row = image.ptr<uchar>(y + i) + x;
+		float* w = &this->window[i*box_size];
+		for (int j = 0; j < box_size; j++) {
+			w[j] = (float) row[j];
+		}
+	}
+
+	for (size_t s = 0; s < this->stages.size(); s++) {
+
+		CascadeStage& stage = this->stages[s];
+
+		int cellsize = box_size/stage.cells;
+		if (cellsize == 0 || box_size/cellsize != stage.cells)
+			CV_Error(CV_StsBadArg, "The window does not split into the cells of a cascade stage");
+
+		this->features.resize(stage.model.var_count);
+		float* f = &this->features[0];
+
+		vl_lbp_process(uniform_lbp(), f, &this->window[0], box_size, box_size, cellsize);
+
+		const float* mean = stage.mean.ptr<float>(0);
+		const float* deviation = stage.deviation.ptr<float>(0);
+		for (int i = 0; i < stage.model.var_count; i++) {
+			f[i] = (f[i] - mean[i])/deviation[i];
+		}
+
+		face_score = stage.model.face_score(f);
+		stage.evaluated++;
+
+		if (face_score < stage.threshold) {
+			if (score)
+				*score = face_score;
+			return false;
+		}
+
+		stage.passed++;
+	}
+
+	if (score)
+		*score = face_score;
+
+	return true;
+}
+
+void SvmCascade::reset_statistics() {
+
+	for (size_t s = 0; s < this->stages.size(); s++) {
+		this->stages[s].evaluated = 0;
+		this->stages[s].passed = 0;
+	}
+}
+
+void SvmCascade::report_statistics() const {
+
+	for (size_t s = 0; s < this->stages.size(); s++) {
+		const CascadeStage& stage = this->stages[s];
+		LOGD("cascade stage %d (%d-d, %d SVs): passed %d of %d windows", (int) s,
+			 stage.model.var_count, stage.model.sv_count, stage.passed, stage.evaluated);
+	}
+}
@@ -0,0 +1,91 @@
+/*
+ * svmcascade.h
+ */
+
+#ifndef SVMCASCADE_H_
+#define SVMCASCADE_H_
+
+#include <opencv2/core/core.hpp>
+
+#include <string>
+#include <vector>
+
+#include "include/vl/lbp.hpp"
+#include "svmmodel.h"
+
+using namespace cv;
+using namespace std;
+
+// One stage of the cascade: an SVM over a window split into cells x cells
+// LBP cells, its normalisation vectors and the face score a window needs
+// to go on to the next stage.
+struct CascadeStage {
+	SvmModel model;
+	Mat mean;
+	Mat deviation;
+	int cells;
+	double threshold;
+	int evaluated;
+	int passed;
+};
+
+// Coarse-to-fine cascade of SVMs. Every window runs the cheap first stage
+// and only its positives reach the next one, so the descriptor of a later
+// stage is only extracted for the windows the earlier ones let through.
+//
+// The stages see the same descriptors as the rest of the scan, those of
+// vl_lbp_process with a cell size of box_size/cells, which the repo's two
+// models were trained on: classifiers_/ (58-d, one cell per window) and
+// classifiers/ (232-d, 2x2 cells) make a cascade as they are, e.g. with a
+// cascade.xml in the model directory (load()):
+//
+//   <opencv_storage><stages>
+//     <_><model>classifiers_/svm_model.xml</model><mean>classifiers_/mean.txt</mean>
+//        <std>classifiers_/std.txt</std><cells>1</cells><threshold>0</threshold></_>
+//     <_><model>classifiers/svm_model.xml</model><mean>classifiers/mean.txt</mean>
+//        <std>classifiers/std.txt</std><cells>2</cells></_>
+//   </stages></opencv_storage>
+//
+// Paths are relative to the file's directory. A stage's threshold is 0,
+// its model's own decision, unless given; a lower one lets more windows
+// on to the next stage.
+class SvmCascade {
+
+private:
+	vector<CascadeStage> stages;
+	// scratch, vectors so that every copy of the cascade has its own
+	vector<float> window;
+	vector<float> features;
+
+public:
+	SvmCascade();
+
+	virtual ~SvmCascade();
+
+	void add_stage(string model, string mean, string deviation, int cells, double threshold = 0.0);
+
+	// Replaces the stages with those of a cascade.xml, see above.
+	void load(string filename);
+
+	void set_threshold(int stage, double threshold);
+
+	bool empty() const {
+		return this->stages.empty();
+	}
+
+	int size() const {
+		return (int) this->stages.size();
+	}
+
+	// The window of image at (x, y), box_size pixels wide, goes through the
+	// stages until one rejects it; score is the last stage's face score.
+	bool classify(const Mat& image, int x, int y, int box_size, double* score = NULL);
+
+	void reset_statistics();
+
+	// Windows each stage saw and passed since reset_statistics(), to logcat.
+	void report_statistics() const;
+
+};
+
+#endif /* SVMCASCADE_H_ */
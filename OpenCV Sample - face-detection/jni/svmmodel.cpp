@@ -0,0 +1,300 @@
+/*
+ * svmmodel.cpp
+ */
+
+#include "svmmodel.h"
+
+#include <opencv2/core/core_c.h>
+
+#include <cfloat>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+SvmModel::SvmModel() {
+
+	this->kernel_type = CvSVM::RBF;
+	this->gamma = 0.0;
+	this->C = 1.0;
+	this->rho = 0.0;
+	this->var_count = 0;
+	this->sv_count = 0;
+	this->class_labels[0] = -1;
+	this->class_labels[1] = 1;
+
+}
+
+SvmModel::SvmModel(string filename) {
+
+	this->kernel_type = CvSVM::RBF;
+	this->gamma = 0.0;
+	this->C = 1.0;
+	this->rho = 0.0;
+	this->var_count = 0;
+	this->sv_count = 0;
+	this->class_labels[0] = -1;
+	this->class_labels[1] = 1;
+
+	this->load(filename);
+
+}
+
+SvmModel::~SvmModel() {
+}
+
+void SvmModel::load(string filename) {
+
+	FileStorage fs(filename, FileStorage::READ);
+	if (!fs.isOpened())
+		CV_Error(CV_StsError, "Could not open the SVM model " + filename);
+
+	this->read(fs.getFirstTopLevelNode());
+}
+
+void SvmModel::load(const char* data, size_t length) {
+
+	FileStorage fs(string(data, length), FileStorage::READ + FileStorage::MEMORY);
+	if (!fs.isOpened())
+		CV_Error(CV_StsError, "Could not parse the SVM model");
+
+	this->read(fs.getFirstTopLevelNode());
+}
+
+void SvmModel::read(const FileNode& node) {
+
+	string type = (string) node["kernel"]["type"];
+	if (type == "LINEAR")
+		this->kernel_type = CvSVM::LINEAR;
+	else if (type == "RBF")
+		this->kernel_type = CvSVM::RBF;
+	else
+		CV_Error(CV_StsBadArg, "Only LINEAR and RBF SVM kernels are supported");
+
+	this->gamma = (double) node["kernel"]["gamma"];
+	this->C = node["C"].empty() ? 1.0 : (double) node["C"];
+	this->var_count = (int) node["var_count"];
+
+	if ((int) node["class_count"] != 2)
+		CV_Error(CV_StsBadArg, "Only two-class SVM models are supported");
+
+	Mat labels;
+	node["class_labels"] >> labels;
+	this->class_labels[0] = labels.at<int>(0);
+	this->class_labels[1] = labels.at<int>(1);
+
+	FileNode svs = node["support_vectors"];
+	FileNode df = node["decision_functions"][0];
+
+	this->sv_count = (int) df["sv_count"];
+	this->rho = (double) df["rho"];
+
+	// support vectors are stored in decision function order, so a model
+	// with an index list is read through it
+	vector<int> index;
+	if (!df["index"].empty())
+		df["index"] >> index;
+
+	vector<double> alpha;
+	df["alpha"] >> alpha;
+
+	this->support_vectors.create(this->sv_count, this->var_count, CV_32FC1);
+	this->alpha.create(1, this->sv_count, CV_64FC1);
+
+	for (int i = 0; i < this->sv_count; i++) {
+		vector<float> sv;
+		svs[index.empty() ? i : index[i]] >> sv;
+		if ((int) sv.size() != this->var_count)
+			CV_Error(CV_StsParseError, "Support vector length does not match var_count");
+		memcpy(this->support_vectors.ptr<float>(i), &sv[0], this->var_count*sizeof(float));
+		this->alpha.at<double>(i) = alpha[i];
+	}
+}
+
+void SvmModel::assign(const CvSVM& svm) {
+
+	// a trained CvSVM only exposes its decision function through write()
+	FileStorage storage(".xml", FileStorage::WRITE + FileStorage::MEMORY);
+	svm.write(*storage, "svm");
+	string buffer = storage.releaseAndGetString();
+
+	FileStorage model(buffer, FileStorage::READ + FileStorage::MEMORY);
+	this->read(model["svm"]);
+}
+
+void SvmModel::save(string filename, string name) const {
+
+	FileStorage storage(filename, FileStorage::WRITE);
+	if (!storage.isOpened())
+		CV_Error(CV_StsError, "Could not write the SVM model " + filename);
+
+	this->write(*storage, name);
+}
+
+void SvmModel::write(CvFileStorage* fs, string name) const {
+
+	// the layout and type id of CvSVM::write, one decision function indexing
+	// every support vector in order
+	cvStartWriteStruct(fs, name.c_str(), CV_NODE_MAP, CV_TYPE_NAME_ML_SVM);
+
+	cvWriteString(fs, "svm_type", "C_SVC");
+
+	cvStartWriteStruct(fs, "kernel", CV_NODE_MAP + CV_NODE_FLOW);
+	cvWriteString(fs, "type", this->kernel_type == CvSVM::LINEAR ? "LINEAR" : "RBF");
+	if (this->kernel_type == CvSVM::RBF)
+		cvWriteReal(fs, "gamma", this->gamma);
+	cvEndWriteStruct(fs);
+
+	cvWriteReal(fs, "C", this->C);
+
+	cvStartWriteStruct(fs, "term_criteria", CV_NODE_MAP + CV_NODE_FLOW);
+	cvWriteReal(fs, "epsilon", FLT_EPSILON);
+	cvWriteInt(fs, "iterations", 1000);
+	cvEndWriteStruct(fs);
+
+	cvWriteInt(fs, "var_all", this->var_count);
+	cvWriteInt(fs, "var_count", this->var_count);
+	cvWriteInt(fs, "class_count", 2);
+
+	Mat labels = (Mat_<int>(1, 2) << this->class_labels[0], this->class_labels[1]);
+	CvMat c_labels = labels;
+	cvWrite(fs, "class_labels", &c_labels);
+
+	cvWriteInt(fs, "sv_total", this->sv_count);
+
+	cvStartWriteStruct(fs, "support_vectors", CV_NODE_SEQ);
+	for (int i = 0; i < this->sv_count; i++) {
+		cvStartWriteStruct(fs, 0, CV_NODE_SEQ + CV_NODE_FLOW);
+		cvWriteRawData(fs, this->support_vectors.ptr<float>(i), this->var_count, "f");
+		cvEndWriteStruct(fs);
+	}
+	cvEndWriteStruct(fs);
+
+	cvStartWriteStruct(fs, "decision_functions", CV_NODE_SEQ);
+	cvStartWriteStruct(fs, 0, CV_NODE_MAP);
+
+	cvWriteInt(fs, "sv_count", this->sv_count);
+	cvWriteReal(fs, "rho", this->rho);
+
+	cvStartWriteStruct(fs, "alpha", CV_NODE_SEQ + CV_NODE_FLOW);
+	cvWriteRawData(fs, this->alpha.ptr<double>(0), this->sv_count, "d");
+	cvEndWriteStruct(fs);
+
+	std::vector<int> index(this->sv_count);
+	for (int i = 0; i < this->sv_count; i++) {
+		index[i] = i;
+	}
+	cvStartWriteStruct(fs, "index", CV_NODE_SEQ + CV_NODE_FLOW);
+	if (this->sv_count > 0)
+		cvWriteRawData(fs, &index[0], this->sv_count, "i");
+	cvEndWriteStruct(fs);
+
+	cvEndWriteStruct(fs);
+	cvEndWriteStruct(fs);
+
+	cvEndWriteStruct(fs);
+}
+
+double SvmModel::kernel(const float* x, const float* sv) const {
+
+	double s = 0.0;
+
+	if (this->kernel_type == CvSVM::LINEAR) {
+		for (int k = 0; k < this->var_count; k++) {
+			s += (double)x[k]*sv[k];
+		}
+		return s;
+	}
+
+	for (int k = 0; k < this->var_count; k++) {
+		double t = x[k] - sv[k];
+		s += t*t;
+	}
+	return exp(-this->gamma*s);
+}
+
+double SvmModel::decision(const float* x) const {
+
+	double sum = -this->rho;
+	const double* a = this->alpha.ptr<double>(0);
+
+	for (int i = 0; i < this->sv_count; i++) {
+		sum += a[i]*this->kernel(x, this->support_vectors.ptr<float>(i));
+	}
+
+	return sum;
+}
+
+float SvmModel::predict(const float* x) const {
+	return (float) this->class_labels[this->decision(x) > 0 ? 0 : 1];
+}
+
+double SvmModel::face_score(const float* x) const {
+	return this->face_sign()*this->decision(x);
+}
+
+static void read_text_vector(istream& in, Mat& vector) {
+
+	std::vector<float> values;
+	float a;
+
+	while (in >> a) {
+		values.push_back(a);
+	}
+
+	Mat(values, true).reshape(1, 1).copyTo(vector);
+}
+
+void load_text_vector(string filename, Mat& vector) {
+
+	ifstream fin(filename.c_str(), ios::in);
+	if (!fin)
+		CV_Error(CV_StsError, "Could not open " + filename);
+
+	read_text_vector(fin, vector);
+}
+
+void load_text_vector(const char* data, size_t length, Mat& vector) {
+
+	istringstream in(string(data, length));
+	read_text_vector(in, vector);
+}
+
+void load_labelled_features(string filename, Mat& features, Mat& labels) {
+
+	ifstream fin(filename.c_str(), ios::in);
+	if (!fin)
+		CV_Error(CV_StsError, "Could not open " + filename);
+
+	string line;
+	std::vector<float> label_values;
+	Mat rows;
+
+	while (getline(fin, line)) {
+		std::vector<float> values;
+		stringstream ss(line);
+		string field;
+
+		while (getline(ss, field, ',')) {
+			values.push_back((float) atof(field.c_str()));
+		}
+
+		if (values.size() < 2)
+			continue;
+
+		label_values.push_back(values[0]);
+		rows.push_back(Mat(values, true).reshape(1, 1).colRange(1, values.size()));
+	}
+
+	features = rows;
+	Mat(label_values, true).copyTo(labels);
+}
+
+void normalize_features(Mat& features, const Mat& mean, const Mat& deviation) {
+
+	for (int i = 0; i < features.rows; i++) {
+		float* row = features.ptr<float>(i);
+		for (int j = 0; j < features.cols; j++) {
+			row[j] = (row[j] - mean.at<float>(j))/deviation.at<float>(j);
+		}
+	}
+}
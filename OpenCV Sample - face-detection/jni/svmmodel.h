@@ -0,0 +1,90 @@
+/*
+ * svmmodel.h
+ */
+
+#ifndef SVMMODEL_H_
+#define SVMMODEL_H_
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/ml/ml.hpp>
+
+#include <string>
+
+using namespace cv;
+using namespace std;
+
+// The two-class decision function of an svm_model.xml written by CvSVM,
+// read with FileStorage so the support vectors, alphas and rho are at hand
+// (CvSVM keeps them protected). save() writes the same layout back, so a
+// model built here, e.g. a reduced one, loads with CvSVM::load.
+//
+// decision(x) = -rho + sum_i alpha_i K(x, sv_i), and like CvSVM::predict
+// the model answers class_labels[0] when the decision is positive and
+// class_labels[1] otherwise. face_score() flips the sign when needed so
+// that a positive score always means the face label (1).
+class SvmModel {
+
+public:
+	int kernel_type;
+	double gamma;
+	double C;
+	double rho;
+	int var_count;
+	int sv_count;
+	int class_labels[2];
+	Mat support_vectors;
+	Mat alpha;
+
+public:
+	SvmModel();
+
+	SvmModel(string filename);
+
+	virtual ~SvmModel();
+
+	void load(string filename);
+
+	// The same file held in memory, e.g. read from a compressed asset.
+	void load(const char* data, size_t length);
+
+	void read(const FileNode& node);
+
+	void assign(const CvSVM& svm);
+
+	void save(string filename, string name = "my_svm") const;
+
+	void write(CvFileStorage* fs, string name) const;
+
+	bool empty() const {
+		return this->sv_count == 0;
+	}
+
+	double kernel(const float* x, const float* sv) const;
+
+	double decision(const float* x) const;
+
+	float predict(const float* x) const;
+
+	double face_score(const float* x) const;
+
+	double face_sign() const {
+		return this->class_labels[0] == 1 ? 1.0 : -1.0;
+	}
+
+};
+
+// Reads one value per line, as in mean.txt and std.txt, into a 1 x n row.
+void load_text_vector(string filename, Mat& vector);
+
+// The same from the file contents in memory.
+void load_text_vector(const char* data, size_t length, Mat& vector);
+
+// Reads a training set with one sample per line, "label,f1,f2,...", into
+// an n x d CV_32FC1 feature matrix and an n x 1 CV_32FC1 label column.
+// Faces are labelled 1.
+void load_labelled_features(string filename, Mat& features, Mat& labels);
+
+// (x - mean)/std on every row, as LearnOnAndroid does before classifying.
+void normalize_features(Mat& features, const Mat& mean, const Mat& deviation);
+
+#endif /* SVMMODEL_H_ */
@@ -1,14 +1,79 @@
 package org.opencv.samples.facedetect;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
 import org.opencv.core.Mat;
 import org.opencv.core.MatOfRect;
+import org.opencv.core.Rect;
+
+import android.content.res.AssetFileDescriptor;
 
 public class DetectionBasedTracker
 {
+    /* ScanParameters.descriptorMode values, see jni/scanparameters.h; the
+     * integral and sliding histograms need models trained on their own
+     * hard-binned descriptors. */
+    public static final int DESCRIPTOR_VLFEAT = 0;
+    public static final int DESCRIPTOR_INTEGRAL = 1;
+    public static final int DESCRIPTOR_SLIDING = 2;
+
+    /* Scan geometry of mydetector, see jni/scanparameters.h. The defaults
+     * are what it used before they could be set. */
+    public static class ScanParameters {
+        public int stride = 16;
+        public int boxSize = 64;
+        public int cellSize = 64;
+        public double downscale = 0.5;
+        public int blurSize = 3;
+        public double pyramidScale = 0.8;
+        public int pyramidLevels = 1;
+        public int minFaceSize = 0;
+        public int maxFaceSize = 0;
+        public double scoreThreshold = 0.0;
+        public int descriptorMode = DESCRIPTOR_VLFEAT;
+    }
+
+    /* Layout of the result buffer, see jni/detection.h */
+    public static final int MAX_RESULTS = 64;
+    private static final int RESULT_HEADER_BYTES = 8;
+    private static final int RESULT_RECORD_BYTES = 28;
+
+    /* getModelState() values, see jni/detectorsession.h */
+    public static final int MODEL_LOADING = 0;
+    public static final int MODEL_READY = 1;
+    public static final int MODEL_FAILED = 2;
+
     public DetectionBasedTracker(String cascadeName, int minFaceSize) {
         mNativeObj = nativeCreateObject(cascadeName, minFaceSize);
+        nativeSetResultBuffer(mNativeObj, mResults);
+    }
+
+    /* The cascade and, if not null, a model bundle are mapped in place;
+     * without a bundle the models are read from the sdcard. Only entries
+     * aapt stored uncompressed have a file descriptor, which this sample's
+     * build does not ask for. The descriptors can be closed afterwards. */
+    public DetectionBasedTracker(AssetFileDescriptor cascade, AssetFileDescriptor bundle, int minFaceSize) {
+        mNativeObj = nativeCreateObjectFromFd(cascade.getParcelFileDescriptor().getFd(),
+                cascade.getStartOffset(), cascade.getLength(), fd(bundle), offset(bundle), length(bundle),
+                minFaceSize);
+        nativeSetResultBuffer(mNativeObj, mResults);
+    }
+
+    /* File contents, e.g. of compressed resources and assets: the cascade,
+     * and a model bundle or svm_model.xml, mean.txt and std.txt, plus the
+     * optional prefilter.xml and intersection.xml, which may be null; with
+     * the bundle and the model null everything is read from the sdcard. */
+    public DetectionBasedTracker(byte[] cascade, byte[] bundle, byte[] model, byte[] mean, byte[] std,
+            byte[] prefilter, byte[] intersection, int minFaceSize) {
+        mNativeObj = nativeCreateObjectFromBuffer(cascade, bundle, model, mean, std, prefilter, intersection,
+                minFaceSize);
+        nativeSetResultBuffer(mNativeObj, mResults);
     }
 
+    /* start() and stop() run the DetectionBasedTracker thread of a detector
+     * built from a cascade file. One built from a descriptor or from memory
+     * has a plain cascade classifier instead, and they do nothing. */
     public void start() {
         nativeStart(mNativeObj);
     }
@@ -21,12 +86,95 @@ public class DetectionBasedTracker
         nativeSetFaceSize(mNativeObj, size);
     }
 
+    /* Throws IllegalArgumentException when a value is out of range or the
+     * windows do not give the loaded model's descriptor length. */
+    public void setScanParameters(ScanParameters p) {
+        nativeSetScanParameters(mNativeObj, p.stride, p.boxSize, p.cellSize, p.downscale, p.blurSize,
+                p.pyramidScale, p.pyramidLevels, p.minFaceSize, p.maxFaceSize, p.scoreThreshold, p.descriptorMode);
+    }
+
     public void detect(Mat imageGray, MatOfRect faces) {
         nativeDetect(mNativeObj, imageGray.getNativeObjAddr(), faces.getNativeObjAddr());
     }
 
-    public void mydetector(Mat imageGray, Mat imageRgba, MatOfRect faces) {
-        nativeMyDetector(mNativeObj, imageGray.getNativeObjAddr(), imageRgba.getNativeObjAddr(), faces.getNativeObjAddr());
+    /* The faces found go to the result buffer, read them with the
+     * getResult* methods; nothing is allocated per frame. Their boxes are
+     * also drawn on imageRgba, which is otherwise left untouched. */
+    public void mydetector(Mat imageGray, Mat imageRgba) {
+        nativeMyDetector(mNativeObj, imageGray.getNativeObjAddr(), imageRgba.getNativeObjAddr());
+    }
+
+    /* Detection on the Y plane of an NV21 preview frame, read in place:
+     * e.g. CvCameraViewFrame.gray() of a JavaCameraView, a view on the
+     * camera buffer. Nothing is drawn; the faces are in the result buffer,
+     * so the frame only needs converting to RGBA for display. */
+    public void mydetectorNv21(Mat yPlane) {
+        nativeMyDetectorNv21(mNativeObj, yPlane.dataAddr(), yPlane.cols(), yPlane.rows(), (int)yPlane.step1());
+    }
+
+    /* Increases by one with every mydetector call. */
+    public int getResultSequence() {
+        return mResults.getInt(0);
+    }
+
+    public int getResultCount() {
+        return mResults.getInt(4);
+    }
+
+    /* Face i of the last frame, in camera pixels, written into rect. */
+    public void getResultRect(int i, Rect rect) {
+        int at = RESULT_HEADER_BYTES + i*RESULT_RECORD_BYTES;
+        rect.x = mResults.getInt(at);
+        rect.y = mResults.getInt(at + 4);
+        rect.width = mResults.getInt(at + 8);
+        rect.height = mResults.getInt(at + 12);
+    }
+
+    /* The classifier's face score, 0 for the cascade. */
+    public float getResultScore(int i) {
+        return mResults.getFloat(RESULT_HEADER_BYTES + i*RESULT_RECORD_BYTES + 16);
+    }
+
+    /* Pyramid level the face was found at, -1 for the cascade. */
+    public int getResultLevel(int i) {
+        return mResults.getInt(RESULT_HEADER_BYTES + i*RESULT_RECORD_BYTES + 20);
+    }
+
+    /* Stays the same for a face followed from frame to frame. */
+    public int getResultTrack(int i) {
+        return mResults.getInt(RESULT_HEADER_BYTES + i*RESULT_RECORD_BYTES + 24);
+    }
+
+    /* Loads a model bundle file in the background and switches mydetector
+     * over to it without stopping; false while another load is running.
+     * getModelLoadTime() is -1 until the new bundle is in use. */
+    public boolean swapModel(String bundlePath) {
+        return nativeSwapModel(mNativeObj, bundlePath);
+    }
+
+    /* Milliseconds the latest background model load took, or -1 until it
+     * has succeeded (mydetector uses the cascade until the first); check
+     * getModelState() to tell a failed load from one still running. */
+    public double getModelLoadTime() {
+        return nativeModelLoadTime(mNativeObj);
+    }
+
+    /* MODEL_LOADING, MODEL_READY or MODEL_FAILED for the latest load. */
+    public int getModelState() {
+        return nativeModelState(mNativeObj);
+    }
+
+    /* Why the latest load failed, empty unless getModelState() is
+     * MODEL_FAILED. */
+    public String getModelLoadError() {
+        return nativeModelLoadError(mNativeObj);
+    }
+
+    /* Runs the RBF model on the windows the linear pre-filter rejects too
+     * and logs how many faces the pre-filter loses (tag
+     * FaceDetection/LearnOnAndroid). Slow, for measuring a pre-filter. */
+    public void setPrefilterAudit(boolean audit) {
+        nativeSetPrefilterAudit(mNativeObj, audit);
     }
 
     public void release() {
@@ -34,13 +182,42 @@ public class DetectionBasedTracker
         mNativeObj = 0;
     }
 
+    private static int fd(AssetFileDescriptor file) {
+        return file != null ? file.getParcelFileDescriptor().getFd() : -1;
+    }
+
+    private static long offset(AssetFileDescriptor file) {
+        return file != null ? file.getStartOffset() : 0;
+    }
+
+    private static long length(AssetFileDescriptor file) {
+        return file != null ? file.getLength() : 0;
+    }
+
     private long mNativeObj = 0;
+    private final ByteBuffer mResults = ByteBuffer
+            .allocateDirect(RESULT_HEADER_BYTES + MAX_RESULTS*RESULT_RECORD_BYTES)
+            .order(ByteOrder.nativeOrder());
 
     private static native long nativeCreateObject(String cascadeName, int minFaceSize);
+    private static native long nativeCreateObjectFromFd(int cascadeFd, long cascadeOffset, long cascadeLength,
+            int bundleFd, long bundleOffset, long bundleLength, int minFaceSize);
+    private static native long nativeCreateObjectFromBuffer(byte[] cascade, byte[] bundle,
+            byte[] model, byte[] mean, byte[] std, byte[] prefilter, byte[] intersection, int minFaceSize);
     private static native void nativeDestroyObject(long thiz);
     private static native void nativeStart(long thiz);
     private static native void nativeStop(long thiz);
     private static native void nativeSetFaceSize(long thiz, int size);
     private static native void nativeDetect(long thiz, long inputImage, long faces);
-    private static native void nativeMyDetector(long thiz, long inputImageGray, long inputImageRgba, long faces);
+    private static native void nativeMyDetector(long thiz, long inputImageGray, long inputImageRgba);
+    private static native void nativeMyDetectorNv21(long thiz, long yPlane, int width, int height, int stride);
+    private static native void nativeSetResultBuffer(long thiz, ByteBuffer results);
+    private static native void nativeSetPrefilterAudit(long thiz, boolean audit);
+    private static native double nativeModelLoadTime(long thiz);
+    private static native int nativeModelState(long thiz);
+    private static native String nativeModelLoadError(long thiz);
+    private static native boolean nativeSwapModel(long thiz, String bundlePath);
+    private static native void nativeSetScanParameters(long thiz, int stride, int boxSize, int cellSize,
+            double downscale, int blurSize, double pyramidScale, int pyramidLevels,
+            int minFaceSize, int maxFaceSize, double scoreThreshold, int descriptorMode);
 }
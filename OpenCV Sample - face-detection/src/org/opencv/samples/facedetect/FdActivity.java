@@ -1,7 +1,6 @@
 package org.opencv.samples.facedetect;
 
-import java.io.File;
-import java.io.FileOutputStream;
+import java.io.ByteArrayOutputStream;
 import java.io.IOException;
 import java.io.InputStream;
 
@@ -20,10 +19,8 @@ import org.opencv.core.Size;
 import org.opencv.imgproc.Imgproc;
 import org.opencv.android.CameraBridgeViewBase;
 import org.opencv.android.CameraBridgeViewBase.CvCameraViewListener2;
-import org.opencv.objdetect.CascadeClassifier;
 
 import android.app.Activity;
-import android.content.Context;
 import android.os.Bundle;
 import android.util.Log;
 import android.view.Menu;
@@ -46,9 +43,9 @@ public class FdActivity extends Activity implements CvCameraViewListener2 {
 
     private Mat                    mRgba;
     private Mat                    mGray;
-    private File                   mCascadeFile;
-    private CascadeClassifier      mJavaDetector;
     private DetectionBasedTracker  mNativeDetector;
+    private MatOfRect              mFaces;
+    private Rect                   mFace               = new Rect();
 
     private int                    mDetectorType       = JAVA_DETECTOR;
     private String[]               mDetectorName;
@@ -70,31 +67,10 @@ public class FdActivity extends Activity implements CvCameraViewListener2 {
                     System.loadLibrary("detection_based_tracker");
 
                     try {
-                        // load cascade file from application resources
-                        InputStream is = getResources().openRawResource(R.raw.lbpcascade_frontalface);
-                        File cascadeDir = getDir("cascade", Context.MODE_PRIVATE);
-                        mCascadeFile = new File(cascadeDir, "lbpcascade_frontalface.xml");
-                        FileOutputStream os = new FileOutputStream(mCascadeFile);
-
-                        byte[] buffer = new byte[4096];
-                        int bytesRead;
-                        while ((bytesRead = is.read(buffer)) != -1) {
-                            os.write(buffer, 0, bytesRead);
-                        }
-                        is.close();
-                        os.close();
-
-                        mJavaDetector = new CascadeClassifier(mCascadeFile.getAbsolutePath());
-                        if (mJavaDetector.empty()) {
-                            Log.e(TAG, "Failed to load cascade classifier");
-                            mJavaDetector = null;
-                        } else
-                            Log.i(TAG, "Loaded cascade classifier from " + mCascadeFile.getAbsolutePath());
-
-                        mNativeDetector = new DetectionBasedTracker(mCascadeFile.getAbsolutePath(), 0);
-
-                        cascadeDir.delete();
-
+                        // read the cascade, and a model bundle if the APK has one, in
+                        // place; nothing is copied out to a file any more
+                        mNativeDetector = createNativeDetector();
+                        Log.i(TAG, "Loaded cascade classifier");
                     } catch (IOException e) {
                         e.printStackTrace();
                         Log.e(TAG, "Failed to load cascade. Exception thrown: " + e);
@@ -110,9 +86,72 @@ public class FdActivity extends Activity implements CvCameraViewListener2 {
         }
     };
 
+    private DetectionBasedTracker createNativeDetector() throws IOException {
+        // aapt stores res/raw and assets compressed in this build, so they
+        // have no file descriptor to map and are read into memory instead
+        byte[] cascade = read(getResources().openRawResource(R.raw.lbpcascade_frontalface));
+
+        byte[] bundle = readAsset("bundle.xml");
+        byte[] model = null;
+        byte[] mean = null;
+        byte[] std = null;
+        if (bundle == null) {
+            model = readAsset("svm_model.xml");
+            mean = readAsset("mean.txt");
+            std = readAsset("std.txt");
+            if (model == null || mean == null || std == null) {
+                Log.i(TAG, "No models in the APK assets, the models are read from the sdcard");
+                return new DetectionBasedTracker(cascade, null, null, null, null, null, null, 0);
+            }
+        }
+
+        byte[] prefilter = readAsset("prefilter.xml");
+        byte[] intersection = readAsset("intersection.xml");
+
+        // the stages a cascade.xml names are files, which assets are not
+        if (hasAsset("cascade.xml"))
+            Log.i(TAG, "Skipping the cascade.xml asset, the SVM cascade is only read from the sdcard");
+
+        return new DetectionBasedTracker(cascade, bundle, model, mean, std, prefilter, intersection, 0);
+    }
+
+    private byte[] readAsset(String name) throws IOException {
+        InputStream is;
+        try {
+            is = getAssets().open(name);
+        } catch (IOException e) {
+            return null;
+        }
+        return read(is);
+    }
+
+    private boolean hasAsset(String name) {
+        try {
+            getAssets().open(name).close();
+            return true;
+        } catch (IOException e) {
+            return false;
+        }
+    }
+
+    private static byte[] read(InputStream is) throws IOException {
+        try {
+            ByteArrayOutputStream os = new ByteArrayOutputStream();
+
+            byte[] buffer = new byte[4096];
+            int bytesRead;
+            while ((bytesRead = is.read(buffer)) != -1) {
+                os.write(buffer, 0, bytesRead);
+            }
+            return os.toByteArray();
+        } finally {
+            is.close();
+        }
+    }
+
     public FdActivity() {
         mDetectorName = new String[2];
-        mDetectorName[JAVA_DETECTOR] = "Java";
+        mDetectorName[JAVA_DETECTOR] = "Cascade";
         mDetectorName[NATIVE_DETECTOR] = "Native (tracking)";
 
         Log.i(TAG, "Instantiated new " + this.getClass());
@@ -157,11 +196,13 @@ public class FdActivity extends Activity implements CvCameraViewListener2 {
     public void onCameraViewStarted(int width, int height) {
         mGray = new Mat();
         mRgba = new Mat();
+        mFaces = new MatOfRect();
     }
 
     public void onCameraViewStopped() {
         mGray.release();
         mRgba.release();
+        mFaces.release();
     }
         
     public Mat onCameraFrame(CvCameraViewFrame inputFrame) {
@@ -183,12 +224,13 @@ public class FdActivity extends Activity implements CvCameraViewListener2 {
             mNativeDetector.setMinFaceSize(mAbsoluteFaceSize);
         }
 
-        MatOfRect faces = new MatOfRect();
+        MatOfRect faces = mFaces;
 
         if (mDetectorType == JAVA_DETECTOR) {
-            if (mJavaDetector != null)
-                mJavaDetector.detectMultiScale(mGray, faces, 1.1, 2, 2, // TODO: objdetect.CV_HAAR_SCALE_IMAGE
-                        new Size(mAbsoluteFaceSize, mAbsoluteFaceSize), new Size());
+            // the native side runs the same cascade with the parameters
+            // this detector used, without a file to load it from
+            if (mNativeDetector != null)
+                mNativeDetector.detect(mGray, faces);
 
             Rect[] facesArray = faces.toArray();
             for (int i = 0; i < facesArray.length; i++)
@@ -197,8 +239,14 @@ public class FdActivity extends Activity implements CvCameraViewListener2 {
         else if (mDetectorType == NATIVE_DETECTOR) {
             if (mNativeDetector != null){
 //                mNativeDetector.detect(mGray, faces);
-            	mNativeDetector.mydetector(mGray, mRgba, faces);
-
+            	// mGray is the camera's Y plane, scanned in place; the faces
+            	// come back through the result buffer
+            	mNativeDetector.mydetectorNv21(mGray);
+
+            	for (int i = 0; i < mNativeDetector.getResultCount(); i++) {
+            	    mNativeDetector.getResultRect(i, mFace);
+            	    Core.rectangle(mRgba, mFace.tl(), mFace.br(), FACE_RECT_COLOR, 3);
+            	}
             }
         }
         else {
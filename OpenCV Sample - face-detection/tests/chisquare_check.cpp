@@ -0,0 +1,117 @@
+/*
+ * chisquare_check.cpp
+ *
+ * Checks lbp::chi_square_f32, lbp::chi_square_u16 and lbp::chi_square_batch,
+ * whose vector paths divide by an estimated reciprocal, against the scalar
+ * lbp::chi_square_ on random count histograms. The lengths cover the vector
+ * loops and their tails, the bins many zeros (0/0 must count as 0) and
+ * counts up to 65535.
+ *
+ * Host check, built against a desktop OpenCV 2.4:
+ *   g++ -I../jni chisquare_check.cpp ../jni/chisquare.cpp ../jni/histogram.cpp \
+ *       `pkg-config --cflags --libs opencv` -o chisquare_check
+ *
+ * Prints the number of distances off by more than the tolerance and exits
+ * with 1 if there is any.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "chisquare.h"
+#include "histogram.h"
+
+using namespace std;
+
+// relative to the distance, plus a little for distances near zero
+#define TOLERANCE 1e-5
+
+static int random_count(int largest) {
+	// half the bins empty, as in LBP histograms of small cells
+	return rand() % 2 ? 0 : rand() % (largest + 1);
+}
+
+static bool close_enough(double value, double reference) {
+	return fabs(value - reference) <= TOLERANCE*(fabs(reference) + 1.0);
+}
+
+static int check_pair(int n, int largest) {
+
+	Mat counts0(1, n, CV_32SC1), counts1(1, n, CV_32SC1);
+	for (int i = 0; i < n; i++) {
+		counts0.at<int>(i) = random_count(largest);
+		counts1.at<int>(i) = random_count(largest);
+	}
+	double reference = lbp::chi_square_<int>(counts0, counts1);
+
+	Mat probe, gallery, gallery16;
+	counts0.convertTo(probe, CV_32F);
+	counts1.convertTo(gallery, CV_32F);
+	counts1.convertTo(gallery16, CV_16U);
+
+	int bad = 0;
+	float f32 = lbp::chi_square_f32(probe.ptr<float>(0), gallery.ptr<float>(0), n);
+	if (!close_enough(f32, reference)) {
+		printf("f32 n=%d: %g, scalar %g\n", n, f32, reference);
+		bad++;
+	}
+	float u16 = lbp::chi_square_u16(probe.ptr<float>(0), gallery16.ptr<unsigned short>(0), n);
+	if (!close_enough(u16, reference)) {
+		printf("u16 n=%d: %g, scalar %g\n", n, u16, reference);
+		bad++;
+	}
+	return bad;
+}
+
+static int check_batch(int rows, int n) {
+
+	Mat counts(rows, n, CV_32SC1), query(1, n, CV_32SC1);
+	for (int i = 0; i < n; i++) {
+		query.at<int>(i) = random_count(255);
+		for (int r = 0; r < rows; r++) {
+			counts.at<int>(r, i) = random_count(255);
+		}
+	}
+
+	Mat probe, gallery, gallery16;
+	query.convertTo(probe, CV_32F);
+	counts.convertTo(gallery, CV_32F);
+	counts.convertTo(gallery16, CV_16U);
+
+	Mat distances, distances16;
+	lbp::chi_square_batch(probe, gallery, distances);
+	lbp::chi_square_batch(probe, gallery16, distances16);
+
+	int bad = 0;
+	for (int r = 0; r < rows; r++) {
+		double reference = lbp::chi_square_<int>(query, counts.row(r));
+		if (!close_enough(distances.at<float>(r), reference) || !close_enough(distances16.at<float>(r), reference)) {
+			printf("batch row %d of %d: %g and %g, scalar %g\n", r, rows,
+					distances.at<float>(r), distances16.at<float>(r), reference);
+			bad++;
+		}
+	}
+	return bad;
+}
+
+int main() {
+
+	srand(1);
+	int bad = 0;
+
+	for (int n = 1; n <= 67; n++) {
+		bad += check_pair(n, 255);
+	}
+	for (int t = 0; t < 200; t++) {
+		bad += check_pair(1 + rand() % 3000, 255);
+		bad += check_pair(1 + rand() % 300, 65535);
+	}
+
+	// the batch splits galleries of 256 rows or more across threads
+	bad += check_batch(10, 59);
+	bad += check_batch(300, 59*16);
+
+	printf("%d distances off\n", bad);
+	return bad ? 1 : 0;
+}
@@ -0,0 +1,165 @@
+/*
+ * facegallery_check.cpp
+ *
+ * Round trip through FaceGallery: enrolls more faces than one growth step
+ * holds, removes some, enrolls into a freed record, then reopens the file
+ * and checks the records, labels and descriptors came back and a face is
+ * found as its own nearest match. Then corrupts the counts in the header
+ * and checks open() rejects the file without leaking its descriptor.
+ *
+ * Host check, built against a desktop OpenCV 2.4:
+ *   g++ -I../jni facegallery_check.cpp ../jni/facegallery.cpp \
+ *       ../jni/chisquare.cpp ../jni/histogram.cpp ../jni/lbp.cpp \
+ *       ../jni/include/vl/lbp.cpp `pkg-config --cflags --libs opencv` \
+ *       -o facegallery_check
+ *
+ * Prints the number of failed checks and exits with 1 if there is any.
+ */
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "facegallery.h"
+
+using namespace std;
+
+#define GALLERY_FILE "/tmp/facegallery_check.gallery"
+#define FACES (GALLERY_GROW + 44)
+
+static int failed = 0;
+
+static void check(bool ok, const char* what) {
+	if (!ok) {
+		printf("failed: %s\n", what);
+		failed++;
+	}
+}
+
+static Mat synthetic_face(int seed) {
+
+	srand(seed);
+	Mat face(120, 120, CV_8UC1);
+	for (int i = 0; i < face.rows; i++) {
+		for (int j = 0; j < face.cols; j++) {
+			face.at<uchar>(i, j) = (uchar) ((i*(seed % 7 + 1) + j*(seed % 5 + 1)) % 160 + rand() % 96);
+		}
+	}
+	return face;
+}
+
+static int open_descriptors() {
+
+	int n = 0;
+	DIR* dir = opendir("/proc/self/fd");
+	if (dir == NULL)
+		return -1;
+	while (readdir(dir) != NULL) {
+		n++;
+	}
+	closedir(dir);
+	return n;
+}
+
+static void check_round_trip() {
+
+	unlink(GALLERY_FILE);
+
+	FaceGallery gallery(GALLERY_FILE);
+	for (int i = 0; i < FACES; i++) {
+		check(gallery.enroll(synthetic_face(i), 1000 + i) == i, "enroll returns the next id");
+	}
+
+	gallery.remove(3);
+	check(gallery.remove_label(1000 + 10) == 1, "remove_label removes one record");
+	check(gallery.enroll(synthetic_face(FACES), 7) == 3, "enroll reuses the first free record");
+
+	check(gallery.get_count() == FACES, "count after removing");
+	check(gallery.get_live() == FACES - 1, "live after removing");
+
+	Mat before = gallery.get_descriptors().clone();
+	gallery.close();
+
+	gallery.open(GALLERY_FILE);
+	check(gallery.get_count() == FACES, "count after reopening");
+	check(gallery.get_live() == FACES - 1, "live after reopening");
+	check(gallery.get_label(3) == 7 && gallery.is_alive(3), "reused record after reopening");
+	check(!gallery.is_alive(10), "removed record after reopening");
+	check(gallery.get_label(FACES - 1) == 1000 + FACES - 1, "last label after reopening");
+
+	Mat after = gallery.get_descriptors();
+	bool same = before.size() == after.size();
+	for (int i = 0; same && i < after.rows; i++) {
+		same = memcmp(before.ptr(i), after.ptr(i), after.cols*sizeof(unsigned short)) == 0;
+	}
+	check(same, "descriptors after reopening");
+
+	vector<GalleryMatch> matches;
+	gallery.identify(synthetic_face(42), 3, matches);
+	check(matches.size() == 3 && matches[0].id == 42 && matches[0].distance == 0.0f,
+		  "a face is its own nearest match");
+
+	gallery.identify(synthetic_face(10), 1, matches);
+	check(matches.size() == 1 && matches[0].id != 10, "a removed face is not matched");
+}
+
+static void corrupt(size_t offset, int value) {
+
+	int fd = open(GALLERY_FILE, O_RDWR);
+	if (fd < 0 || pwrite(fd, &value, sizeof(value), offset) != (ssize_t) sizeof(value))
+		printf("could not corrupt %s\n", GALLERY_FILE);
+	if (fd >= 0)
+		close(fd);
+}
+
+static void check_rejected(const char* what) {
+
+	int descriptors = open_descriptors();
+	bool rejected = false;
+
+	FaceGallery gallery;
+	try {
+		gallery.open(GALLERY_FILE);
+	} catch (cv::Exception&) {
+		rejected = true;
+	}
+	check(rejected, what);
+	check(!gallery.is_open() && open_descriptors() == descriptors, "a rejected file is closed");
+}
+
+static void check_corrupt_header() {
+
+	int capacity = 0;
+	int fd = open(GALLERY_FILE, O_RDONLY);
+	if (fd < 0 || pread(fd, &capacity, sizeof(capacity), offsetof(GalleryHeader, capacity)) != (ssize_t) sizeof(capacity))
+		printf("could not read %s\n", GALLERY_FILE);
+	if (fd >= 0)
+		close(fd);
+
+	corrupt(offsetof(GalleryHeader, count), capacity + 1);
+	check_rejected("count above capacity");
+
+	corrupt(offsetof(GalleryHeader, count), FACES);
+	corrupt(offsetof(GalleryHeader, live), FACES + 1);
+	check_rejected("live above count");
+
+	corrupt(offsetof(GalleryHeader, live), FACES - 1);
+	FaceGallery gallery(GALLERY_FILE);
+	check(gallery.get_live() == FACES - 1, "the restored header opens");
+}
+
+int main() {
+
+	check_round_trip();
+	check_corrupt_header();
+
+	unlink(GALLERY_FILE);
+
+	printf("%d failed checks\n", failed);
+	return failed ? 1 : 0;
+}
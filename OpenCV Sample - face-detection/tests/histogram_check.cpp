@@ -0,0 +1,117 @@
+/*
+ * histogram_check.cpp
+ *
+ * Checks lbp::histogram, lbp::parallel_histogram and lbp::spatial_histogram
+ * against plain per-pixel counts on random code images, from a few pixels
+ * up to camera frames (the parallel variant only splits images of 65536
+ * pixels or more). The spatial cases cover both the strip and the direct
+ * counting of overlapping cells.
+ *
+ * Host check, built against a desktop OpenCV 2.4:
+ *   g++ -I../jni histogram_check.cpp ../jni/histogram.cpp \
+ *       `pkg-config --cflags --libs opencv` -o histogram_check
+ *
+ * Prints the number of mismatching bins and exits with 1 if there is any.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "histogram.h"
+
+using namespace std;
+
+#define PATTERNS 59
+
+static Mat random_codes(int rows, int cols) {
+
+	Mat codes(rows, cols, CV_8UC1);
+	for (int i = 0; i < rows; i++) {
+		for (int j = 0; j < cols; j++) {
+			// long runs of one code, as in flat regions, and noise
+			codes.at<uchar>(i, j) = (rand() % 4 == 0) ? (uchar) (rand() % PATTERNS) : (uchar) (i/8 % PATTERNS);
+		}
+	}
+	return codes;
+}
+
+static int count_mismatches(const Mat& codes, const Rect& area, const int* hist) {
+
+	int reference[PATTERNS] = { 0 };
+	for (int i = area.y; i < area.y + area.height; i++) {
+		for (int j = area.x; j < area.x + area.width; j++) {
+			reference[codes.at<uchar>(i, j)]++;
+		}
+	}
+
+	int bad = 0;
+	for (int k = 0; k < PATTERNS; k++) {
+		if (hist[k] != reference[k])
+			bad++;
+	}
+	return bad;
+}
+
+static int check_histograms(int rows, int cols) {
+
+	Mat codes = random_codes(rows, cols);
+	Rect all(0, 0, cols, rows);
+
+	Mat serial, parallel;
+	lbp::histogram(codes, serial, PATTERNS);
+	lbp::parallel_histogram(codes, parallel, PATTERNS);
+
+	return count_mismatches(codes, all, serial.ptr<int>(0)) + count_mismatches(codes, all, parallel.ptr<int>(0));
+}
+
+static int check_spatial(int rows, int cols, Size window, int overlap) {
+
+	Mat codes = random_codes(rows, cols);
+
+	Mat hist;
+	lbp::spatial_histogram(codes, hist, PATTERNS, window, overlap);
+
+	int stepx = window.width - overlap;
+	int stepy = window.height - overlap;
+	int cells = 0;
+	int bad = 0;
+	for (int y = 0; y + window.height <= rows; y += stepy) {
+		for (int x = 0; x + window.width <= cols; x += stepx) {
+			bad += count_mismatches(codes, Rect(x, y, window.width, window.height), hist.ptr<int>(0) + cells*PATTERNS);
+			cells++;
+		}
+	}
+
+	if (hist.cols != cells*PATTERNS) {
+		printf("spatial %dx%d window %dx%d overlap %d: %d bins, expected %d\n",
+				cols, rows, window.width, window.height, overlap, hist.cols, cells*PATTERNS);
+		bad++;
+	}
+	return bad;
+}
+
+int main() {
+
+	srand(1);
+	int bad = 0;
+
+	bad += check_histograms(1, 1);
+	bad += check_histograms(7, 13);
+	bad += check_histograms(255, 257);
+	bad += check_histograms(256, 256);
+	bad += check_histograms(480, 640);
+	bad += check_histograms(720, 1280);
+
+	for (int t = 0; t < 200; t++) {
+		int rows = 8 + rand() % 120;
+		int cols = 8 + rand() % 120;
+		Size window(1 + rand() % cols, 1 + rand() % rows);
+		int overlap = rand() % min(window.width, window.height);
+		bad += check_spatial(rows, cols, window, overlap);
+	}
+	bad += check_spatial(480, 640, Size(8, 8), 1);
+	bad += check_spatial(480, 640, Size(64, 64), 48);
+
+	printf("%d mismatching bins\n", bad);
+	return bad ? 1 : 0;
+}
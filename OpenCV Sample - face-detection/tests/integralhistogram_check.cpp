@@ -0,0 +1,116 @@
+/*
+ * integralhistogram_check.cpp
+ *
+ * Checks the four-corner lookups of IntegralHistogram against counts of
+ * the LBP bins taken pixel by pixel. Half of the image is flat, so one bin
+ * holds far more than 65535 pixels and the 16-bit integrals wrap around;
+ * the windows are read top to bottom, so the band of integral rows wraps
+ * around its ring, then from the top again, then at random, with
+ * rectangles up to INTEGRAL_MAX_AREA pixels.
+ *
+ * Host check, built against a desktop OpenCV 2.4:
+ *   g++ -I../jni integralhistogram_check.cpp ../jni/integralhistogram.cpp \
+ *       ../jni/include/vl/lbp.cpp `pkg-config --cflags --libs opencv` \
+ *       -o integralhistogram_check
+ *
+ * Prints the number of rectangles whose counts differ and exits with 1 if
+ * there is any.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "integralhistogram.h"
+
+using namespace std;
+
+static Mat test_image(int width, int height) {
+
+	Mat image(height, width, CV_8UC1);
+	for (int i = 0; i < height; i++) {
+		for (int j = 0; j < width; j++) {
+			image.at<uchar>(i, j) = j < width/2 ? 100 : (uchar) ((i*5 + j*3) % 97 + rand() % 160);
+		}
+	}
+	return image;
+}
+
+static int check_rectangle(IntegralHistogram& integral, int x, int y, int w, int h) {
+
+	integral.cover(y, y + h);
+
+	unsigned short hist[LBP_BINS];
+	integral.histogram(x, y, w, h, hist);
+
+	int counts[LBP_BINS];
+	memset(counts, 0, sizeof(counts));
+	const Mat& bins = integral.get_bins();
+	for (int i = y; i < y + h; i++) {
+		for (int j = x; j < x + w; j++) {
+			if (bins.at<uchar>(i, j) < LBP_BINS)
+				counts[bins.at<uchar>(i, j)]++;
+		}
+	}
+
+	for (int k = 0; k < LBP_BINS; k++) {
+		if (hist[k] != counts[k]) {
+			printf("%dx%d at (%d, %d): bin %d counts %d, not %d\n", w, h, x, y, k, hist[k], counts[k]);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int check_scan(IntegralHistogram& integral, int box_size, int cellsize, int stride) {
+
+	int bad = 0;
+	for (int y = 0; y + box_size < integral.get_height(); y += stride) {
+		for (int x = 0; x + box_size < integral.get_width(); x += stride) {
+			for (int cy = 0; cy < box_size/cellsize; cy++) {
+				for (int cx = 0; cx < box_size/cellsize; cx++) {
+					bad += check_rectangle(integral, x + cx*cellsize, y + cy*cellsize, cellsize, cellsize);
+				}
+			}
+		}
+	}
+	return bad;
+}
+
+int main() {
+
+	srand(1);
+	int bad = 0;
+
+	Mat image = test_image(640, 480);
+	IntegralHistogram integral;
+	integral.build(image);
+
+	// the ring is one box high, every row is computed once per scan
+	bad += check_scan(integral, 64, 64, 16);
+	bad += check_scan(integral, 64, 32, 24);
+	bad += check_scan(integral, 64, 16, 32);
+
+	// the largest rectangles whose counts are exact, down the image and
+	// back up, which starts the band from the top again
+	for (int y = 0; y + 257 <= image.rows; y += 37) {
+		bad += check_rectangle(integral, (y*7) % (image.cols - 255), y, 255, 257);
+	}
+	bad += check_rectangle(integral, 0, 0, 255, 257);
+	bad += check_rectangle(integral, image.cols - 257, 3, 257, 255);
+
+	for (int r = 0; r < 2000; r++) {
+		int w = 1 + rand() % 255;
+		int h = 1 + rand() % min(image.rows, INTEGRAL_MAX_AREA/w);
+		int x = rand() % (image.cols - w + 1);
+		int y = rand() % (image.rows - h + 1);
+		bad += check_rectangle(integral, x, y, w, h);
+	}
+
+	// a new image of the same width keeps the ring
+	integral.build(test_image(640, 360));
+	bad += check_scan(integral, 64, 32, 16);
+
+	printf("%d rectangles differ\n", bad);
+	return bad ? 1 : 0;
+}
@@ -0,0 +1,168 @@
+/*
+ * model_swap_check.cpp
+ *
+ * Checks that EpochPointer, which DetectorSession publishes its models
+ * through, never frees an object a reader still holds.
+ *
+ * The first case replays the interleaving that used to lose models: a
+ * reader reads the epoch and is preempted before counting itself in, a
+ * publish goes by, the reader takes the new object, and a second publish
+ * comes while the reader still uses it. The second case runs readers
+ * against a writer publishing as fast as it can.
+ *
+ * Freed objects are only marked dead, never returned to the heap, so a
+ * reader can look at what it holds after it was freed.
+ *
+ * Host check:
+ *   g++ -I../jni model_swap_check.cpp -lpthread -o model_swap_check
+ *
+ * Prints the number of uses of a freed object and exits with 1 if there
+ * is any.
+ */
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+
+static void preempted();
+
+#define EPOCH_POINTER_PREEMPTED() preempted()
+
+#include "epochpointer.h"
+
+#define READERS 4
+#define PUBLISHES 2000
+
+struct Model {
+
+	volatile bool alive;
+
+	Model() : alive(true) {
+	}
+
+	~Model() {
+		this->alive = false;
+	}
+
+	static void* operator new(size_t size) {
+		return ::operator new(size);
+	}
+
+	// kept readable after delete
+	static void operator delete(void*) {
+	}
+};
+
+static EpochPointer<Model> models;
+
+static volatile int preempt_next = 0;
+static sem_t reader_preempted, reader_resumed, reader_acquired, reader_check;
+static volatile int freed_uses = 0;
+
+static void preempted() {
+
+	if (__sync_bool_compare_and_swap(&preempt_next, 1, 0)) {
+		sem_post(&reader_preempted);
+		sem_wait(&reader_resumed);
+	}
+}
+
+static void* preempted_reader(void*) {
+
+	int slot;
+	preempt_next = 1;
+	const Model* model = models.acquire(slot);
+
+	sem_post(&reader_acquired);
+	sem_wait(&reader_check);
+
+	if (!model->alive)
+		__sync_fetch_and_add(&freed_uses, 1);
+	models.release(slot);
+
+	return NULL;
+}
+
+static void* publisher(void*) {
+
+	models.publish(new Model());
+	return NULL;
+}
+
+static void check_preempted_reader() {
+
+	sem_init(&reader_preempted, 0, 0);
+	sem_init(&reader_resumed, 0, 0);
+	sem_init(&reader_acquired, 0, 0);
+	sem_init(&reader_check, 0, 0);
+
+	models.publish(new Model());
+
+	pthread_t reader;
+	pthread_create(&reader, NULL, preempted_reader, NULL);
+
+	// the reader has read the epoch and is not counted in yet
+	sem_wait(&reader_preempted);
+	models.publish(new Model());
+	sem_post(&reader_resumed);
+	sem_wait(&reader_acquired);
+
+	// must wait for the reader, which holds the object just published
+	pthread_t writer;
+	pthread_create(&writer, NULL, publisher, NULL);
+	usleep(50000);
+
+	sem_post(&reader_check);
+	pthread_join(reader, NULL);
+	pthread_join(writer, NULL);
+
+	printf("preempted reader: %d uses of a freed model\n", freed_uses);
+}
+
+static volatile bool stop_readers = false;
+
+static void* stress_reader(void*) {
+
+	while (!stop_readers) {
+		int slot;
+		const Model* model = models.acquire(slot);
+		for (int spin = rand() % 100; spin > 0; spin--) {
+			if (!model->alive) {
+				__sync_fetch_and_add(&freed_uses, 1);
+				break;
+			}
+		}
+		models.release(slot);
+	}
+	return NULL;
+}
+
+static void check_stress() {
+
+	int before = freed_uses;
+
+	pthread_t readers[READERS];
+	for (int i = 0; i < READERS; i++)
+		pthread_create(&readers[i], NULL, stress_reader, NULL);
+
+	for (int i = 0; i < PUBLISHES; i++)
+		models.publish(new Model());
+
+	stop_readers = true;
+	for (int i = 0; i < READERS; i++)
+		pthread_join(readers[i], NULL);
+
+	printf("stress: %d uses of a freed model\n", freed_uses - before);
+}
+
+int main() {
+
+	check_preempted_reader();
+	check_stress();
+
+	printf("%d uses of a freed model\n", freed_uses);
+	return freed_uses ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * nv21_check.cpp
+ *
+ * Checks the way nativeMyDetectorNv21 reads a camera frame: the Y plane of
+ * a synthetic NV21 buffer, wrapped with rows stride bytes apart, must give
+ * the same pyramid levels (ScanParameters::build_level) as a packed copy
+ * of the luma, and must be left untouched. The row padding and the VU
+ * plane hold other values, so reading them would change the levels.
+ *
+ * Host check, built against a desktop OpenCV 2.4:
+ *   g++ -I../jni nv21_check.cpp ../jni/scanparameters.cpp \
+ *       `pkg-config --cflags --libs opencv` -o nv21_check
+ *
+ * Prints the number of failed cases and exits with 1 if there is any.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "scanparameters.h"
+
+using namespace cv;
+using namespace std;
+
+static bool same(const Mat& a, const Mat& b) {
+
+	if (a.size() != b.size() || a.type() != b.type())
+		return false;
+
+	for (int i = 0; i < a.rows; i++) {
+		if (memcmp(a.ptr(i), b.ptr(i), a.cols*a.elemSize()) != 0)
+			return false;
+	}
+	return true;
+}
+
+static int check_frame(int width, int height, int stride, int blur_size) {
+
+	// Y plane, then the interleaved VU plane at half resolution
+	vector<uchar> nv21(stride*height + stride*(height/2));
+	for (size_t k = 0; k < nv21.size(); k++) {
+		nv21[k] = (uchar) (255 - rand() % 16);
+	}
+	for (int i = 0; i < height; i++) {
+		for (int j = 0; j < width; j++) {
+			nv21[i*stride + j] = (uchar) ((i*3 + j*5) % 200 + rand() % 8);
+		}
+	}
+	vector<uchar> before = nv21;
+
+	Mat luma(height, width, CV_8UC1, &nv21[0], (size_t) stride);
+	Mat packed = luma.clone();
+
+	ScanParameters parameters;
+	parameters.blur_size = blur_size;
+	parameters.pyramid_levels = 3;
+
+	int bad = 0;
+	Mat blurred, level, expected_blurred, expected;
+	for (int l = 0; l < parameters.pyramid_levels; l++) {
+
+		parameters.build_level(luma, l, blurred, level);
+		parameters.build_level(packed, l, expected_blurred, expected);
+
+		double scale = parameters.level_scale(l);
+		if (level.size() != Size(cvRound(width*scale), cvRound(height*scale)) || !same(level, expected)) {
+			printf("%dx%d stride %d blur %d: level %d differs\n", width, height, stride, blur_size, l);
+			bad++;
+		}
+	}
+
+	if (nv21 != before) {
+		printf("%dx%d stride %d blur %d: the frame was written to\n", width, height, stride, blur_size);
+		bad++;
+	}
+	return bad;
+}
+
+int main() {
+
+	srand(1);
+	int bad = 0;
+
+	int frames[][3] = {
+		{ 640, 480, 640 },
+		{ 640, 480, 704 },
+		{ 320, 240, 336 },
+		{ 176, 144, 192 },
+		{ 1280, 720, 1280 },
+		{ 1280, 720, 1344 },
+	};
+	for (size_t f = 0; f < sizeof(frames)/sizeof(frames[0]); f++) {
+		bad += check_frame(frames[f][0], frames[f][1], frames[f][2], 1);
+		bad += check_frame(frames[f][0], frames[f][1], frames[f][2], 3);
+	}
+
+	printf("%d failed cases\n", bad);
+	return bad ? 1 : 0;
+}
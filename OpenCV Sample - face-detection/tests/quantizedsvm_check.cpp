@@ -0,0 +1,99 @@
+/*
+ * quantizedsvm_check.cpp
+ *
+ * Checks squared_distance_s8 and dot_product_s8, whose vector loops take
+ * 16 values at a time, against plain loops over the same values. The
+ * lengths cover the vector loops and odd tails, the values the whole
+ * range the quantizer writes, and rows of +127 against -127 the largest
+ * differences and products.
+ *
+ * Host check, built against a desktop OpenCV 2.4 (with -mfpu=neon or on
+ * AArch64 the NEON loops are checked instead of the SSE2 ones):
+ *   g++ -I../jni quantizedsvm_check.cpp ../jni/quantizedsvm.cpp ../jni/svmmodel.cpp \
+ *       `pkg-config --cflags --libs opencv` -o quantizedsvm_check
+ *
+ * Prints the number of results that differ and exits with 1 if there is
+ * any.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "quantizedsvm.h"
+
+using namespace std;
+
+static int check_pair(const vector<schar>& a, const vector<schar>& b) {
+
+	int n = (int) a.size();
+	int distance = 0, dot = 0;
+	for (int i = 0; i < n; i++) {
+		int d = a[i] - b[i];
+		distance += d*d;
+		dot += a[i]*b[i];
+	}
+
+	const schar* pa = n > 0 ? &a[0] : NULL;
+	const schar* pb = n > 0 ? &b[0] : NULL;
+
+	int bad = 0;
+	int s = squared_distance_s8(pa, pb, n);
+	if (s != distance) {
+		printf("squared_distance_s8 n=%d: %d, not %d\n", n, s, distance);
+		bad++;
+	}
+	int p = dot_product_s8(pa, pb, n);
+	if (p != dot) {
+		printf("dot_product_s8 n=%d: %d, not %d\n", n, p, dot);
+		bad++;
+	}
+	return bad;
+}
+
+static schar random_value() {
+	// what quantize_value writes, the ends more often
+	switch (rand() % 8) {
+	case 0:
+		return 127;
+	case 1:
+		return -127;
+	default:
+		return (schar) (rand() % 255 - 127);
+	}
+}
+
+int main() {
+
+	srand(1);
+	int bad = 0;
+
+	vector<int> lengths;
+	for (int n = 0; n <= 67; n++)
+		lengths.push_back(n);
+	lengths.push_back(231);
+	lengths.push_back(233);
+	lengths.push_back(1023);
+	lengths.push_back(4097);
+
+	for (size_t l = 0; l < lengths.size(); l++) {
+		int n = lengths[l];
+
+		for (int t = 0; t < 20; t++) {
+			vector<schar> a(n), b(n);
+			for (int i = 0; i < n; i++) {
+				a[i] = random_value();
+				b[i] = random_value();
+			}
+			bad += check_pair(a, b);
+		}
+
+		vector<schar> high(n, 127), low(n, -127);
+		bad += check_pair(high, low);
+		bad += check_pair(low, low);
+		bad += check_pair(high, high);
+	}
+
+	printf("%d results differ\n", bad);
+	return bad ? 1 : 0;
+}
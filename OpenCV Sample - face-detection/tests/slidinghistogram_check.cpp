@@ -0,0 +1,137 @@
+/*
+ * slidinghistogram_check.cpp
+ *
+ * Checks that SlidingHistogram (DESCRIPTOR_SLIDING) gives the same window
+ * descriptors as IntegralHistogram (DESCRIPTOR_INTEGRAL), bit for bit,
+ * over a scan of random images. The strides cover moves by less than a
+ * cell, by whole cells, by more than a cell but not a whole number of
+ * them, and by the whole window, then random moves, some back and to
+ * other rows.
+ *
+ * Host check, built against a desktop OpenCV 2.4:
+ *   g++ -I../jni slidinghistogram_check.cpp ../jni/slidinghistogram.cpp \
+ *       ../jni/integralhistogram.cpp ../jni/include/vl/lbp.cpp \
+ *       `pkg-config --cflags --libs opencv` -o slidinghistogram_check
+ *
+ * Prints the number of windows that differ and exits with 1 if there is
+ * any.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "integralhistogram.h"
+#include "slidinghistogram.h"
+
+using namespace std;
+
+static Mat random_image(int width, int height) {
+
+	Mat image(height, width, CV_8UC1);
+	for (int i = 0; i < height; i++) {
+		for (int j = 0; j < width; j++) {
+			image.at<uchar>(i, j) = (uchar) ((i*7 + j*3) % 128 + rand() % 128);
+		}
+	}
+	return image;
+}
+
+static int check_window(IntegralHistogram& integral, SlidingHistogram& sliding,
+						int x, int y, int box_size, int cellsize) {
+
+	int cells = box_size/cellsize;
+	int dimension = cells*cells*LBP_BINS;
+	vector<float> expected(dimension), features(dimension);
+
+	integral.cover(y, y + box_size);
+	integral.cell_features(x, y, box_size, cellsize, &expected[0]);
+
+	sliding.move_to(x, y);
+	sliding.cell_features(&features[0]);
+
+	if (memcmp(&expected[0], &features[0], dimension*sizeof(float)) != 0) {
+		printf("box %d cell %d: window at (%d, %d) differs\n", box_size, cellsize, x, y);
+		return 1;
+	}
+	return 0;
+}
+
+static int check_scan(const Mat& image, int box_size, int cellsize, int stride) {
+
+	IntegralHistogram integral;
+	integral.build(image);
+
+	SlidingHistogram sliding;
+	sliding.set_image(image);
+	sliding.set_geometry(box_size, cellsize);
+
+	// the order LearnOnAndroid::scaning_image visits the windows in
+	int bad = 0;
+	for (int y = 0; y + box_size < image.rows; y += stride) {
+		for (int x = 0; x + box_size < image.cols; x += stride) {
+			bad += check_window(integral, sliding, x, y, box_size, cellsize);
+		}
+	}
+	return bad;
+}
+
+static int check_random_moves(const Mat& image, int box_size, int cellsize) {
+
+	IntegralHistogram integral;
+	integral.build(image);
+
+	SlidingHistogram sliding;
+	sliding.set_image(image);
+	sliding.set_geometry(box_size, cellsize);
+
+	int bad = 0;
+	int x = 0, y = 0;
+	for (int m = 0; m < 500; m++) {
+		// mostly to the right along the row, sometimes back or down
+		int move = rand() % 10;
+		if (move == 0) {
+			x = rand() % (image.cols - box_size);
+		} else if (move == 1) {
+			y = min(y + 1 + rand() % 8, image.rows - box_size - 1);
+			x = rand() % (image.cols - box_size);
+		} else {
+			x += rand() % (3*cellsize + 1);
+			if (x + box_size >= image.cols)
+				x = rand() % cellsize;
+		}
+		bad += check_window(integral, sliding, x, y, box_size, cellsize);
+	}
+	return bad;
+}
+
+int main() {
+
+	srand(1);
+	int bad = 0;
+
+	Mat image = random_image(320, 240);
+
+	int geometries[][2] = {
+		{ 64, 64 },
+		{ 64, 32 },
+		{ 64, 16 },
+		{ 60, 20 },
+		{ 48, 8 },
+	};
+	for (size_t g = 0; g < sizeof(geometries)/sizeof(geometries[0]); g++) {
+		int box_size = geometries[g][0];
+		int cellsize = geometries[g][1];
+
+		int strides[] = { 1, 4, cellsize - 1, cellsize, cellsize + 5, 2*cellsize, 3*cellsize + 1, box_size };
+		for (size_t s = 0; s < sizeof(strides)/sizeof(strides[0]); s++) {
+			if (strides[s] > 0)
+				bad += check_scan(image, box_size, cellsize, strides[s]);
+		}
+		bad += check_random_moves(image, box_size, cellsize);
+	}
+
+	printf("%d windows differ\n", bad);
+	return bad ? 1 : 0;
+}
@@ -0,0 +1,139 @@
+/*
+ * dump_features.cpp
+ *
+ * Writes the hard-binned LBP descriptors that DESCRIPTOR_INTEGRAL and
+ * DESCRIPTOR_SLIDING scan with, for training models on them: the shipped
+ * models were trained on the bilinear cells of vl_lbp_process, which these
+ * modes do not compute.
+ *
+ * Host tool, built against a desktop OpenCV 2.4:
+ *   g++ -O2 -I../jni dump_features.cpp ../jni/integralhistogram.cpp \
+ *       ../jni/include/vl/lbp.cpp `pkg-config --cflags --libs opencv` -o dump_features
+ *
+ * Usage:
+ *   dump_features windows.txt features.csv [box_size] [cell_size] [mean.txt std.txt]
+ *
+ * windows.txt lists one training window per line, "label,image", with
+ * faces labelled 1; each image is read as grayscale and resized to
+ * box_size (64 by default) the way the scanner scales its levels, so it
+ * should be cut from a frame blurred like the scanned ones. cell_size is
+ * 64 by default. features.csv gets one "label,f1,f2,..." line per window,
+ * the input of tools/train_prefilter.cpp and the other training tools;
+ * with mean.txt and std.txt the tool also writes the per-feature mean and
+ * standard deviation the scanner normalises with.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "integralhistogram.h"
+#include "scanparameters.h"
+
+using namespace cv;
+using namespace std;
+
+static void write_vector(const char* filename, const Mat& vector) {
+
+	FILE* out = fopen(filename, "w");
+	if (out == NULL)
+		CV_Error(CV_StsError, string("Could not write ") + filename);
+	for (int i = 0; i < vector.cols; i++) {
+		fprintf(out, "%f\n", vector.at<double>(i));
+	}
+	fclose(out);
+}
+
+int main(int argc, char** argv) {
+
+	if (argc < 3 || argc == 6) {
+		cerr << "usage: " << argv[0]
+			 << " windows.txt features.csv [box_size] [cell_size] [mean.txt std.txt]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	int box_size = argc > 3 ? atoi(argv[3]) : BOX_SIZE;
+	int cell_size = argc > 4 ? atoi(argv[4]) : DEFAULT_CELLSIZE;
+	if (cell_size <= 0 || box_size % cell_size != 0 || cell_size*cell_size > INTEGRAL_MAX_AREA) {
+		cerr << "box size must be a multiple of a cell size below 256" << endl;
+		return EXIT_FAILURE;
+	}
+
+	ifstream windows(argv[1]);
+	if (!windows) {
+		cerr << "could not read " << argv[1] << endl;
+		return EXIT_FAILURE;
+	}
+	ofstream csv(argv[2]);
+	if (!csv) {
+		cerr << "could not write " << argv[2] << endl;
+		return EXIT_FAILURE;
+	}
+
+	int cells = box_size/cell_size;
+	int dimension = cells*cells*LBP_BINS;
+	vector<float> features(dimension);
+
+	IntegralHistogram integral;
+	Mat sum = Mat::zeros(1, dimension, CV_64FC1);
+	Mat squares = Mat::zeros(1, dimension, CV_64FC1);
+	int count = 0;
+
+	string line;
+	while (getline(windows, line)) {
+
+		size_t comma = line.find(',');
+		if (comma == string::npos)
+			continue;
+		int label = atoi(line.substr(0, comma).c_str());
+		string filename = line.substr(comma + 1);
+
+		Mat image = imread(filename, CV_LOAD_IMAGE_GRAYSCALE);
+		if (image.empty()) {
+			cerr << "skipping " << filename << ", not an image" << endl;
+			continue;
+		}
+
+		// the outermost pixels of a crop have no neighbours and so no LBP
+		// code, unlike those of a window inside a scanned level
+		Mat window;
+		resize(image, window, Size(box_size, box_size));
+
+		integral.build(window);
+		integral.cover(0, box_size);
+		integral.cell_features(0, 0, box_size, cell_size, &features[0]);
+
+		csv << label;
+		for (int i = 0; i < dimension; i++) {
+			csv << "," << features[i];
+			sum.at<double>(i) += features[i];
+			squares.at<double>(i) += (double) features[i]*features[i];
+		}
+		csv << "\n";
+		count++;
+	}
+
+	cout << "wrote " << count << " windows of " << dimension << " features to " << argv[2] << endl;
+
+	if (argc > 6 && count > 0) {
+		Mat mean = sum/count;
+		Mat deviation(1, dimension, CV_64FC1);
+		for (int i = 0; i < dimension; i++) {
+			double variance = squares.at<double>(i)/count - mean.at<double>(i)*mean.at<double>(i);
+			// a feature that never changes must not divide by zero
+			deviation.at<double>(i) = variance > 1e-12 ? sqrt(variance) : 1.0;
+		}
+		write_vector(argv[5], mean);
+		write_vector(argv[6], deviation);
+	}
+
+	return EXIT_SUCCESS;
+}
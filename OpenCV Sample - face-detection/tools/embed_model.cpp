@@ -0,0 +1,110 @@
+/*
+ * embed_model.cpp
+ *
+ * Writes an RBF model and its mean/std as a C++ header, so the detector
+ * can be built with the model compiled in (ndk-build EMBED_MODEL=1)
+ * instead of reading svm_model.xml, mean.txt and std.txt at run time.
+ *
+ * Host tool, built against a desktop OpenCV 2.4:
+ *   g++ -I../jni embed_model.cpp ../jni/svmmodel.cpp \
+ *       `pkg-config --cflags --libs opencv` -o embed_model
+ *
+ * Usage:
+ *   embed_model svm_model.xml mean.txt std.txt ../jni/embedded_model.h
+ *
+ * Floats are printed with 9 significant digits and doubles with 17, so
+ * the embedded model is bit-identical to the XML one.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "svmmodel.h"
+
+using namespace std;
+
+static void write_floats(FILE* out, const char* name, const float* values, int count) {
+
+	fprintf(out, "static const float %s[%d] __attribute__((aligned(64))) = {", name, count);
+	for (int i = 0; i < count; i++) {
+		fprintf(out, "%s%.9g", i % 8 ? ", " : (i ? ",\n\t" : "\n\t"), values[i]);
+	}
+	fprintf(out, "\n};\n\n");
+}
+
+static void write_doubles(FILE* out, const char* name, const double* values, int count) {
+
+	fprintf(out, "static const double %s[%d] __attribute__((aligned(64))) = {", name, count);
+	for (int i = 0; i < count; i++) {
+		fprintf(out, "%s%.17g", i % 4 ? ", " : (i ? ",\n\t" : "\n\t"), values[i]);
+	}
+	fprintf(out, "\n};\n\n");
+}
+
+int main(int argc, char** argv) {
+
+	if (argc < 5) {
+		cerr << "usage: " << argv[0] << " svm_model.xml mean.txt std.txt embedded_model.h" << endl;
+		return EXIT_FAILURE;
+	}
+
+	SvmModel model(argv[1]);
+	if (model.kernel_type != CvSVM::RBF) {
+		cerr << "only RBF models are embedded" << endl;
+		return EXIT_FAILURE;
+	}
+
+	Mat mean, deviation;
+	load_text_vector(argv[2], mean);
+	load_text_vector(argv[3], deviation);
+
+	if (mean.cols != model.var_count || deviation.cols != model.var_count) {
+		cerr << "mean and std do not match the model" << endl;
+		return EXIT_FAILURE;
+	}
+
+	FILE* out = fopen(argv[4], "w");
+	if (!out) {
+		cerr << "could not write " << argv[4] << endl;
+		return EXIT_FAILURE;
+	}
+
+	fprintf(out, "/*\n * embedded_model.h\n *\n"
+				 " * Generated by tools/embed_model.cpp from %s, do not edit.\n */\n\n", argv[1]);
+	fprintf(out, "#ifndef EMBEDDED_MODEL_H_\n#define EMBEDDED_MODEL_H_\n\n");
+	fprintf(out, "#include \"staticrbfmodel.h\"\n\n");
+
+	fprintf(out, "#define EMBEDDED_VAR_COUNT %d\n", model.var_count);
+	fprintf(out, "#define EMBEDDED_SV_COUNT %d\n\n", model.sv_count);
+
+	fprintf(out, "static const double embedded_gamma = %.17g;\n", model.gamma);
+	fprintf(out, "static const double embedded_rho = %.17g;\n\n", model.rho);
+
+	write_floats(out, "embedded_support_vectors", model.support_vectors.ptr<float>(0),
+				 model.sv_count*model.var_count);
+	write_doubles(out, "embedded_alpha", model.alpha.ptr<double>(0), model.sv_count);
+	write_floats(out, "embedded_mean", mean.ptr<float>(0), model.var_count);
+	write_floats(out, "embedded_deviation", deviation.ptr<float>(0), model.var_count);
+
+	// the Model of StaticRbfModel, see staticrbfmodel.h
+	fprintf(out, "struct EmbeddedModel {\n"
+				 "\tenum { var_count = EMBEDDED_VAR_COUNT, sv_count = EMBEDDED_SV_COUNT, first_label = %d };\n"
+				 "\tstatic double gamma() { return embedded_gamma; }\n"
+				 "\tstatic double rho() { return embedded_rho; }\n"
+				 "\tstatic const float* support_vectors() { return embedded_support_vectors; }\n"
+				 "\tstatic const double* alpha() { return embedded_alpha; }\n"
+				 "\tstatic const float* mean() { return embedded_mean; }\n"
+				 "\tstatic const float* deviation() { return embedded_deviation; }\n"
+				 "};\n\n", model.class_labels[0]);
+
+	fprintf(out, "typedef StaticRbfModel<EmbeddedModel> EmbeddedRbfModel;\n\n");
+
+	fprintf(out, "#endif /* EMBEDDED_MODEL_H_ */\n");
+	fclose(out);
+
+	cout << "wrote " << argv[4] << ": " << model.sv_count << " SVs of "
+		 << model.var_count << " features" << endl;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,87 @@
+/*
+ * feature_map.cpp
+ *
+ * Fits explicit feature maps to an RBF model and reports, for each map
+ * dimension, how often the linearised model agrees with the exact one and
+ * what a window costs.
+ *
+ * Host tool, built against a desktop OpenCV 2.4:
+ *   g++ -I../jni feature_map.cpp ../jni/featuremap.cpp ../jni/svmmodel.cpp \
+ *       `pkg-config --cflags --libs opencv` -o feature_map
+ *
+ * Usage:
+ *   feature_map svm_model.xml features.csv mean.txt std.txt fourier|nystrom
+ *               [dimensions] [feature_map.xml]
+ *
+ * dimensions is a comma separated list, 32,64,128,256,512 by default. The
+ * map of the last dimension is written to feature_map.xml when given.
+ * features.csv is the same "label,f1,f2,..." file train_prefilter reads.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "featuremap.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+
+	if (argc < 6) {
+		cerr << "usage: " << argv[0]
+			 << " svm_model.xml features.csv mean.txt std.txt fourier|nystrom"
+			 << " [dimensions] [feature_map.xml]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	string type_name = argv[5];
+	int type = type_name == "nystrom" ? FEATURE_MAP_NYSTROM : FEATURE_MAP_FOURIER;
+
+	vector<int> dimensions;
+	stringstream list(argc > 6 ? argv[6] : "32,64,128,256,512");
+	string field;
+	while (getline(list, field, ',')) {
+		dimensions.push_back(atoi(field.c_str()));
+	}
+
+	SvmModel model(argv[1]);
+
+	Mat features, labels, mean, deviation;
+	load_labelled_features(argv[2], features, labels);
+	load_text_vector(argv[3], mean);
+	load_text_vector(argv[4], deviation);
+	normalize_features(features, mean, deviation);
+
+	double tick = getTickFrequency()/1000.0;
+
+	int64 start = getTickCount();
+	for (int i = 0; i < features.rows; i++) {
+		model.decision(features.ptr<float>(i));
+	}
+	double exact = (getTickCount() - start)/tick/features.rows;
+
+	cout << "exact: " << model.sv_count << " SVs, "
+		 << exact << " ms per window" << endl;
+
+	FeatureMap map;
+	for (size_t k = 0; k < dimensions.size(); k++) {
+
+		map.fit(model, type, dimensions[k]);
+
+		Mat decisions;
+		start = getTickCount();
+		map.decision(features, decisions);
+		double approximate = (getTickCount() - start)/tick/features.rows;
+
+		cout << type_name << " " << map.get_dimension() << ": agreement "
+			 << 100.0*map.agreement(model, features) << "%, "
+			 << approximate << " ms per window" << endl;
+	}
+
+	if (argc > 7)
+		map.save(argv[7]);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,54 @@
+/*
+ * make_bundle.cpp
+ *
+ * Packs existing model files into one model bundle; the bundle type picks
+ * the classifier backend the scanner runs (see jni/classifierpolicy.h).
+ *
+ * Host tool, built against a desktop OpenCV 2.4:
+ *   g++ -O2 -I../jni make_bundle.cpp ../jni/modelbundle.cpp \
+ *       ../jni/featureprojection.cpp ../jni/svmmodel.cpp ../jni/linearsvm.cpp \
+ *       ../jni/intersectionsvm.cpp ../jni/quantizedsvm.cpp \
+ *       `pkg-config --cflags --libs opencv` -o make_bundle
+ *
+ * Usage:
+ *   make_bundle rbf svm_model.xml mean.txt std.txt bundle.xml
+ *   make_bundle linear prefilter.xml mean.txt std.txt bundle.xml
+ *   make_bundle quantized svm_model.xml mean.txt std.txt bundle.xml
+ *   make_bundle intersection intersection.xml bundle.xml
+ */
+
+#include <cstdlib>
+#include <iostream>
+
+#include "modelbundle.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+
+	if (argc < 4 || (string(argv[1]) != "intersection" && argc < 6)) {
+		cerr << "usage: " << argv[0] << " rbf|linear|quantized model mean.txt std.txt bundle.xml" << endl
+			 << "       " << argv[0] << " intersection intersection.xml bundle.xml" << endl;
+		return EXIT_FAILURE;
+	}
+
+	int type = ModelBundle::type_from_name(argv[1]);
+
+	ModelBundle bundle;
+	string output;
+
+	if (type == BUNDLE_INTERSECTION) {
+		bundle.assign(argv[2], "", "", type);
+		output = argv[3];
+	} else {
+		bundle.assign(argv[2], argv[3], argv[4], type);
+		output = argv[5];
+	}
+
+	bundle.save(output);
+
+	cout << "wrote " << output << ": " << argv[1] << " bundle over "
+		 << bundle.get_descriptor_dimension() << "-d descriptors" << endl;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+/*
+ * pq_index.cpp
+ *
+ * Builds the product-quantization index of a face gallery's descriptors,
+ * writes it, and reports recall@k against exact chi-square search and the
+ * search time for a range of re-ranking depths.
+ *
+ * Host tool, built against a desktop OpenCV 2.4:
+ *   g++ -O2 -I../jni pq_index.cpp ../jni/pqindex.cpp ../jni/facegallery.cpp \
+ *       ../jni/chisquare.cpp ../jni/histogram.cpp ../jni/lbp.cpp \
+ *       ../jni/include/vl/lbp.cpp `pkg-config --cflags --libs opencv` -o pq_index
+ *
+ * Usage:
+ *   pq_index gallery.bin index.pq [subspaces] [k] [reranks] [queries]
+ *
+ * Only live gallery records are indexed, in gallery order. subspaces is 64
+ * by default, k 10; reranks is a comma separated list of re-ranking depths,
+ * 0 for the approximate distances alone, 0,50,100,200 by default. queries
+ * gallery records, 200 by default, spread evenly over it, are searched.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "facegallery.h"
+#include "pqindex.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+
+	if (argc < 3) {
+		cerr << "usage: " << argv[0]
+			 << " gallery.bin index.pq [subspaces] [k] [reranks] [queries]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	int subspaces = argc > 3 ? atoi(argv[3]) : PQ_DEFAULT_SUBSPACES;
+	int k = argc > 4 ? atoi(argv[4]) : 10;
+
+	vector<int> reranks;
+	stringstream list(argc > 5 ? argv[5] : "0,50,100,200");
+	string field;
+	while (getline(list, field, ',')) {
+		reranks.push_back(atoi(field.c_str()));
+	}
+
+	int query_count = argc > 6 ? atoi(argv[6]) : 200;
+
+	FaceGallery gallery(argv[1]);
+
+	Mat all = gallery.get_descriptors();
+	Mat descriptors(0, gallery.get_dimension(), CV_16UC1);
+	for (int i = 0; i < gallery.get_count(); i++) {
+		if (gallery.is_alive(i))
+			descriptors.push_back(all.row(i));
+	}
+
+	if (descriptors.rows < 2) {
+		cerr << argv[1] << ": " << descriptors.rows << " live records, an index needs 2" << endl;
+		return EXIT_FAILURE;
+	}
+
+	PQIndex index(subspaces);
+	index.build(descriptors);
+	index.save(argv[2]);
+
+	cout << "wrote " << argv[2] << ": " << index.get_count() << " records, "
+		 << index.get_code_size() << " bytes each" << endl;
+
+	query_count = max(1, min(query_count, descriptors.rows));
+	Mat queries(0, descriptors.cols, CV_16UC1);
+	for (int q = 0; q < query_count; q++) {
+		queries.push_back(descriptors.row((int)((int64)q*descriptors.rows/query_count)));
+	}
+
+	vector<PQRecall> report;
+	index.evaluate(queries, descriptors, k, reranks, report);
+
+	for (size_t r = 0; r < report.size(); r++) {
+		cout << "rerank " << report[r].rerank << ": recall@" << k << " = " << report[r].recall
+			 << ", " << report[r].milliseconds << " ms/query" << endl;
+	}
+
+	return EXIT_SUCCESS;
+}
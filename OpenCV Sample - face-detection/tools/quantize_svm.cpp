@@ -0,0 +1,70 @@
+/*
+ * quantize_svm.cpp
+ *
+ * Compares the int8 evaluation of an RBF model with the float one: how
+ * often the decision flips, the support vector memory and the cost per
+ * window.
+ *
+ * Host tool, built against a desktop OpenCV 2.4:
+ *   g++ -O2 -I../jni quantize_svm.cpp ../jni/quantizedsvm.cpp ../jni/svmmodel.cpp \
+ *       `pkg-config --cflags --libs opencv` -o quantize_svm
+ *
+ * Usage:
+ *   quantize_svm svm_model.xml features.csv mean.txt std.txt
+ *
+ * features.csv is the same "label,f1,f2,..." file train_prefilter reads,
+ * with raw descriptors.
+ */
+
+#include <cstdlib>
+#include <iostream>
+
+#include "quantizedsvm.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+
+	if (argc < 5) {
+		cerr << "usage: " << argv[0] << " svm_model.xml features.csv mean.txt std.txt" << endl;
+		return EXIT_FAILURE;
+	}
+
+	SvmModel model(argv[1]);
+
+	Mat features, labels, mean, deviation;
+	load_labelled_features(argv[2], features, labels);
+	load_text_vector(argv[3], mean);
+	load_text_vector(argv[4], deviation);
+
+	QuantizedSvm quantized;
+	quantized.quantize(model, mean, deviation);
+
+	Mat normalized = features.clone();
+	normalize_features(normalized, mean, deviation);
+
+	double tick = getTickFrequency()/1000.0;
+	volatile double sink = 0.0;
+
+	int64 start = getTickCount();
+	for (int i = 0; i < normalized.rows; i++) {
+		sink += model.decision(normalized.ptr<float>(i));
+	}
+	double exact = (getTickCount() - start)/tick/features.rows;
+
+	start = getTickCount();
+	for (int i = 0; i < features.rows; i++) {
+		sink += quantized.decision(features.ptr<float>(i));
+	}
+	double approximate = (getTickCount() - start)/tick/features.rows;
+
+	cout << "support vectors: " << model.sv_count << " x " << model.var_count << ", "
+		 << model.support_vectors.total()*sizeof(float) << " bytes float, "
+		 << quantized.memory() << " bytes int8" << endl;
+	cout << "float: " << exact << " ms per window, int8: " << approximate
+		 << " ms per window" << endl;
+	cout << "decision flips: " << 100.0*quantized.flip_rate(model, features)
+		 << "% of " << features.rows << " windows" << endl;
+
+	return EXIT_SUCCESS;
+}
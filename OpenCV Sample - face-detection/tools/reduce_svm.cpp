@@ -0,0 +1,94 @@
+/*
+ * reduce_svm.cpp
+ *
+ * Compresses an RBF model to fewer, synthetic support vectors and picks the
+ * smallest one that still agrees with the original often enough on a
+ * held-out feature set.
+ *
+ * Host tool, built against a desktop OpenCV 2.4:
+ *   g++ -O2 -I../jni reduce_svm.cpp ../jni/reducedset.cpp ../jni/svmmodel.cpp \
+ *       `pkg-config --cflags --libs opencv` -o reduce_svm
+ *
+ * Usage:
+ *   reduce_svm svm_model.xml heldout.csv mean.txt std.txt reduced_model.xml
+ *              [agreement] [counts]
+ *
+ * agreement is the fraction of held-out decisions that must not change,
+ * 0.99 by default; counts is a comma separated list of sizes to try in
+ * increasing order, 10,20,30,50,75,100,150,200 by default. The first size
+ * that reaches the agreement is written, otherwise the last one tried.
+ * The written file is read back with CvSVM::load and checked again.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "reducedset.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+
+	if (argc < 6) {
+		cerr << "usage: " << argv[0]
+			 << " svm_model.xml heldout.csv mean.txt std.txt reduced_model.xml"
+			 << " [agreement] [counts]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	double target = argc > 6 ? atof(argv[6]) : 0.99;
+
+	vector<int> counts;
+	stringstream list(argc > 7 ? argv[7] : "10,20,30,50,75,100,150,200");
+	string field;
+	while (getline(list, field, ',')) {
+		counts.push_back(atoi(field.c_str()));
+	}
+
+	SvmModel model(argv[1]);
+
+	Mat features, labels, mean, deviation;
+	load_labelled_features(argv[2], features, labels);
+	load_text_vector(argv[3], mean);
+	load_text_vector(argv[4], deviation);
+	normalize_features(features, mean, deviation);
+
+	cout << "original: " << model.sv_count << " SVs, "
+		 << features.rows << " held-out windows" << endl;
+
+	SvmModel reduced;
+	double agreement = 0.0;
+
+	for (size_t k = 0; k < counts.size(); k++) {
+
+		reduce_support_vectors(model, counts[k], reduced);
+		agreement = decision_agreement(model, reduced, features);
+
+		cout << reduced.sv_count << " SVs: agreement " << 100.0*agreement
+			 << "%, relative error " << reduction_error(model, reduced) << endl;
+
+		if (agreement >= target)
+			break;
+	}
+
+	if (agreement < target)
+		cout << "no size reached " << 100.0*target << "%, keeping the last one" << endl;
+
+	reduced.save(argv[5]);
+
+	// the written model goes through CvSVM, as the detector loads it
+	CvSVM svm;
+	svm.load(argv[5]);
+
+	int agree = 0;
+	for (int i = 0; i < features.rows; i++) {
+		agree += (svm.predict(features.row(i)) == model.predict(features.ptr<float>(i)));
+	}
+
+	cout << "wrote " << argv[5] << ": " << svm.get_support_vector_count()
+		 << " SVs, CvSVM agreement " << 100.0*agree/max(features.rows, 1) << "%" << endl;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,56 @@
+/*
+ * train_intersection.cpp
+ *
+ * Trains the intersection-kernel SVM and exports its per-dimension lookup
+ * tables.
+ *
+ * Host tool, built against a desktop OpenCV 2.4:
+ *   g++ -I../jni train_intersection.cpp ../jni/intersectionsvm.cpp \
+ *       ../jni/linearsvm.cpp ../jni/svmmodel.cpp \
+ *       `pkg-config --cflags --libs opencv` -o train_intersection
+ *
+ * Usage:
+ *   train_intersection features.csv intersection.xml [bins] [C]
+ *
+ * features.csv holds one raw LBP descriptor per line, "label,f1,f2,...",
+ * with faces labelled 1. Unlike train_prefilter the descriptors are not
+ * normalised with mean.txt/std.txt: the kernel needs the histograms.
+ */
+
+#include <cstdlib>
+#include <iostream>
+
+#include "intersectionsvm.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+
+	if (argc < 3) {
+		cerr << "usage: " << argv[0]
+			 << " features.csv intersection.xml [bins] [C]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	int bins = argc > 3 ? atoi(argv[3]) : INTERSECTION_BINS;
+	double C = argc > 4 ? atof(argv[4]) : 1.0;
+
+	Mat features, labels;
+	load_labelled_features(argv[1], features, labels);
+
+	cout << "training on " << features.rows << " samples of "
+		 << features.cols << " features, " << bins << " bins" << endl;
+
+	IntersectionSvm svm;
+	svm.train(features, labels, bins, C);
+	svm.save(argv[2]);
+
+	int correct = 0;
+	for (int i = 0; i < features.rows; i++) {
+		correct += (svm.predict(features.ptr<float>(i)) == (labels.at<float>(i) == 1.0f ? 1.0f : -1.0f));
+	}
+
+	cout << "training accuracy " << 100.0*correct/features.rows << "%" << endl;
+
+	return EXIT_SUCCESS;
+}
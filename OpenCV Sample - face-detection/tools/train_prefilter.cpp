@@ -0,0 +1,51 @@
+/*
+ * train_prefilter.cpp
+ *
+ * Trains the linear pre-filter that runs in front of the RBF model.
+ *
+ * Host tool, built against a desktop OpenCV 2.4:
+ *   g++ -I../jni train_prefilter.cpp ../jni/linearsvm.cpp ../jni/svmmodel.cpp \
+ *       `pkg-config --cflags --libs opencv` -o train_prefilter
+ *
+ * Usage:
+ *   train_prefilter features.csv mean.txt std.txt prefilter.xml [recall] [C]
+ *
+ * features.csv holds one raw LBP descriptor per line, "label,f1,f2,...",
+ * with faces labelled 1; they are normalised with mean.txt/std.txt like the
+ * scanner does.
+ */
+
+#include <cstdlib>
+#include <iostream>
+
+#include "linearsvm.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+
+	if (argc < 5) {
+		cerr << "usage: " << argv[0]
+			 << " features.csv mean.txt std.txt prefilter.xml [recall] [C]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	double recall = argc > 5 ? atof(argv[5]) : PREFILTER_TARGET_RECALL;
+	double C = argc > 6 ? atof(argv[6]) : 1.0;
+
+	Mat features, labels, mean, deviation;
+
+	load_labelled_features(argv[1], features, labels);
+	load_text_vector(argv[2], mean);
+	load_text_vector(argv[3], deviation);
+	normalize_features(features, mean, deviation);
+
+	cout << "training on " << features.rows << " samples of "
+		 << features.cols << " features" << endl;
+
+	LinearSvm prefilter;
+	prefilter.train(features, labels, recall, C);
+	prefilter.save(argv[4]);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+/*
+ * train_projected.cpp
+ *
+ * Fits a PCA projection on the training descriptors, retrains the RBF SVM
+ * in the reduced space and writes both, with mean/std folded into the
+ * projection, as one model bundle.
+ *
+ * Host tool, built against a desktop OpenCV 2.4:
+ *   g++ -O2 -I../jni train_projected.cpp ../jni/modelbundle.cpp \
+ *       ../jni/featureprojection.cpp ../jni/svmmodel.cpp ../jni/linearsvm.cpp \
+ *       ../jni/intersectionsvm.cpp ../jni/quantizedsvm.cpp \
+ *       `pkg-config --cflags --libs opencv` -o train_projected
+ *
+ * Usage:
+ *   train_projected features.csv mean.txt std.txt components bundle.xml
+ *                   [whiten] [C] [gamma]
+ *
+ * whiten is 0 or 1, 0 by default. Without C and gamma they are picked by
+ * CvSVM::train_auto. features.csv is the same "label,f1,f2,..." file
+ * train_prefilter reads, with raw descriptors.
+ */
+
+#include <cstdlib>
+#include <iostream>
+
+#include "modelbundle.h"
+
+using namespace std;
+
+int main(int argc, char** argv) {
+
+	if (argc < 6) {
+		cerr << "usage: " << argv[0]
+			 << " features.csv mean.txt std.txt components bundle.xml [whiten] [C] [gamma]" << endl;
+		return EXIT_FAILURE;
+	}
+
+	int components = atoi(argv[4]);
+	bool whiten = argc > 6 && atoi(argv[6]) != 0;
+
+	Mat features, labels, mean, deviation;
+	load_labelled_features(argv[1], features, labels);
+	load_text_vector(argv[2], mean);
+	load_text_vector(argv[3], deviation);
+
+	ModelBundle bundle;
+	bundle.projection.fit(features, mean, deviation, components, whiten);
+
+	Mat projected;
+	bundle.projection.apply(features, projected);
+
+	cout << "training on " << projected.rows << " samples, " << features.cols
+		 << " -> " << projected.cols << " features" << endl;
+
+	CvSVMParams params;
+	params.svm_type = CvSVM::C_SVC;
+	params.kernel_type = CvSVM::RBF;
+	params.term_crit = cvTermCriteria(CV_TERMCRIT_ITER | CV_TERMCRIT_EPS, 1000, FLT_EPSILON);
+
+	CvSVM svm;
+	if (argc > 8) {
+		params.C = atof(argv[7]);
+		params.gamma = atof(argv[8]);
+		svm.train(projected, labels, Mat(), Mat(), params);
+	} else {
+		svm.train_auto(projected, labels, Mat(), Mat(), params);
+	}
+
+	bundle.svm.assign(svm);
+	bundle.save(argv[5]);
+
+	int correct = 0;
+	for (int i = 0; i < projected.rows; i++) {
+		correct += (bundle.svm.predict(projected.ptr<float>(i)) == labels.at<float>(i));
+	}
+
+	cout << "wrote " << argv[5] << ": " << bundle.svm.sv_count << " SVs, gamma "
+		 << bundle.svm.gamma << ", C " << bundle.svm.C << ", training accuracy "
+		 << 100.0*correct/projected.rows << "%" << endl;
+
+	return EXIT_SUCCESS;
+}